@@ -0,0 +1,530 @@
+/**
+ * Microbenchmarks of the game's hot functions: collision tests, DoCollisions,
+ * particle and ball updates, level loading and resetting.
+ *
+ * Every benchmark runs a few warmup samples, then REPETITIONS timed samples of
+ * a fixed number of operations each. Per-operation times are summarized (min,
+ * median, mean, standard deviation, max) in a table and written to a JSON file
+ * so runs can be compared.
+ *
+ * No OpenGL context is needed: the handful of GL calls made while loading
+ * textures and creating the particle generator are pointed at no-op functions.
+ *
+ * Built with make bench PROFILE=1 the PROFILE_ZONE benchmark measures the cost
+ * of one instrumentation zone, and every other benchmark includes its zones.
+ *
+ * usage: microbench [--json <file>] [--filter <substring>] [--reps <n>]
+ * Run from the repo root (levels/ and textures/ are loaded): make bench
+ */
+#include "Game.h"
+#include "AudioMixer.h"
+#include "BallObject.h"
+#include "FrameArena.h"
+#include "GameLevel.h"
+#include "LevelGenerator.h"
+#include "OverlayRenderer.h"
+#include "ParticleGenerator.h"
+#include "PowerUps.h"
+#include "Profiler.h"
+#include "ResourceManager.h"
+#include "StateSnapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const unsigned int WARMUP = 3;
+unsigned int REPETITIONS = 15;
+
+const unsigned int WIDTH = 800, HEIGHT = 600;
+
+// -- no-op OpenGL ------------------------------------------------------------
+
+static GLuint NextName = 1;
+
+static void APIENTRY nullGen(GLsizei n, GLuint *names)
+{
+    for (GLsizei i = 0; i < n; i++)
+        names[i] = NextName++;
+}
+static void APIENTRY nullDelete(GLsizei, const GLuint*) { }
+static void APIENTRY nullBind(GLenum, GLuint) { }
+static void APIENTRY nullBindVertexArray(GLuint) { }
+static void APIENTRY nullTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) { }
+static void APIENTRY nullTexParameteri(GLenum, GLenum, GLint) { }
+static void APIENTRY nullBufferData(GLenum, GLsizeiptr, const void*, GLenum) { }
+static void APIENTRY nullVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) { }
+static void APIENTRY nullEnableVertexAttribArray(GLuint) { }
+
+static void useNullGL()
+{
+    glad_glGenTextures = nullGen;
+    glad_glDeleteTextures = nullDelete;
+    glad_glBindTexture = nullBind;
+    glad_glTexImage2D = nullTexImage2D;
+    glad_glTexParameteri = nullTexParameteri;
+    glad_glGenVertexArrays = nullGen;
+    glad_glDeleteVertexArrays = nullDelete;
+    glad_glBindVertexArray = nullBindVertexArray;
+    glad_glGenBuffers = nullGen;
+    glad_glDeleteBuffers = nullDelete;
+    glad_glBindBuffer = nullBind;
+    glad_glBufferData = nullBufferData;
+    glad_glVertexAttribPointer = nullVertexAttribPointer;
+    glad_glEnableVertexAttribArray = nullEnableVertexAttribArray;
+}
+
+// -- harness -----------------------------------------------------------------
+
+// keeps the compiler from optimizing away a result that is never used
+template <typename T>
+inline void keep(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct BenchResult
+{
+    std::string Name;
+    std::string Params;
+    unsigned int Operations; // per sample
+    double Min, Median, Mean, StdDev, Max; // nanoseconds per operation
+};
+
+std::vector<BenchResult> Results;
+std::string Filter;
+
+/**
+ * Times body (which does operations operations) WARMUP + REPETITIONS times.
+ * setup runs before every sample and is not timed.
+ */
+static void bench(const std::string &name, const std::string &params, unsigned int operations,
+                  std::function<void()> setup, std::function<void()> body)
+{
+    std::string fullName = params.empty() ? name : name + "/" + params;
+    if (!Filter.empty() && fullName.find(Filter) == std::string::npos)
+        return;
+
+    std::vector<double> samples;
+    for (unsigned int r = 0; r < WARMUP + REPETITIONS; r++)
+    {
+        if (setup)
+            setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (r >= WARMUP)
+            samples.push_back(ns / operations);
+    }
+
+    BenchResult result;
+    result.Name = name;
+    result.Params = params;
+    result.Operations = operations;
+
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    result.Min = samples.front();
+    result.Max = samples.back();
+    result.Median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+    double sum = 0.0;
+    for (double s : samples)
+        sum += s;
+    result.Mean = sum / n;
+    double squares = 0.0;
+    for (double s : samples)
+        squares += (s - result.Mean) * (s - result.Mean);
+    result.StdDev = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+
+    std::printf("%-44s %12.1f %12.1f %10.1f %12.1f  ns/op\n", fullName.c_str(), result.Median, result.Mean, result.StdDev, result.Min);
+    std::fflush(stdout);
+    Results.push_back(result);
+}
+
+static bool writeJson(const char *file)
+{
+    FILE *out = std::fopen(file, "w");
+    if (out == nullptr)
+    {
+        std::cout << "ERROR: could not write file: " << file << std::endl;
+        return false;
+    }
+
+    std::fprintf(out, "{\n  \"warmup\": %u,\n  \"repetitions\": %u,\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n", WARMUP, REPETITIONS);
+    for (size_t i = 0; i < Results.size(); i++)
+    {
+        const BenchResult &r = Results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", \"params\": \"%s\", \"operations\": %u, "
+                          "\"min\": %.3f, \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, \"max\": %.3f}%s\n",
+                     r.Name.c_str(), r.Params.c_str(), r.Operations,
+                     r.Min, r.Median, r.Mean, r.StdDev, r.Max, i + 1 < Results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+    return std::fclose(out) == 0;
+}
+
+// -- inputs ------------------------------------------------------------------
+
+// small deterministic generator, so every run benchmarks the same inputs
+static uint64_t RandomState = 1;
+
+static float random01()
+{
+    RandomState = RandomState * 6364136223846793005ull + 1442695040888963407ull;
+    return (RandomState >> 40) / static_cast<float>(1 << 24);
+}
+
+static glm::vec2 randomVec2(glm::vec2 min, glm::vec2 max)
+{
+    return min + glm::vec2(random01(), random01()) * (max - min);
+}
+
+static LevelData generateLevel(unsigned int width, unsigned int height, std::vector<unsigned char> &tiles)
+{
+    LevelGeneratorSettings settings;
+    settings.Width = width;
+    settings.Height = height;
+    settings.Seed = 42;
+    return LevelGenerator::Generate(settings, tiles);
+}
+
+static std::string sizeName(unsigned int width, unsigned int height)
+{
+    return std::to_string(width) + "x" + std::to_string(height);
+}
+
+// level sizes in tiles, from the stock levels up to a million bricks
+const unsigned int LEVEL_SIZES[][2] = { { 15, 8 }, { 128, 128 }, { 512, 512 }, { 1024, 1024 } };
+
+// -- benchmarks --------------------------------------------------------------
+
+const unsigned int INPUT_COUNT = 4096;
+
+static void benchCollisionTests()
+{
+    std::vector<glm::vec2> directions(INPUT_COUNT);
+    for (glm::vec2 &d : directions)
+        d = randomVec2(glm::vec2(-1.0f), glm::vec2(1.0f));
+    bench("VectorDirection", "", INPUT_COUNT, nullptr, [&]() {
+        for (const glm::vec2 &d : directions)
+            keep(VectorDirection(d));
+    });
+
+    // boxes in a small area, so about half of the pairs overlap
+    std::vector<GameObject> boxes;
+    for (unsigned int i = 0; i < INPUT_COUNT + 1; i++)
+        boxes.emplace_back(randomVec2(glm::vec2(0.0f), glm::vec2(200.0f)), glm::vec2(64.0f, 32.0f), TextureView());
+    bench("CheckCollision(AABB)", "", INPUT_COUNT, nullptr, [&]() {
+        for (unsigned int i = 0; i < INPUT_COUNT; i++)
+            keep(CheckCollision(boxes[i], boxes[i + 1]));
+    });
+
+    std::vector<BallObject> balls;
+    for (unsigned int i = 0; i < INPUT_COUNT; i++)
+        balls.emplace_back(randomVec2(glm::vec2(0.0f), glm::vec2(200.0f)), 12.5f, glm::vec2(100.0f, -350.0f), TextureView());
+    bench("CheckCollision(circle)", "", INPUT_COUNT, nullptr, [&]() {
+        for (unsigned int i = 0; i < INPUT_COUNT; i++)
+            keep(CheckCollision(balls[i], boxes[i]));
+    });
+}
+
+static void benchBall()
+{
+    const unsigned int STEPS = 100000;
+    BallObject ball(glm::vec2(400.0f, 300.0f), 12.5f, glm::vec2(100.0f, -350.0f), TextureView());
+    ball.Stuck = false;
+    bench("BallObject::Move", "", STEPS, nullptr, [&]() {
+        for (unsigned int i = 0; i < STEPS; i++)
+        {
+            keep(ball.Move(1.0f / 120.0f, WIDTH));
+            if (ball.Position.y > HEIGHT) // fell out the bottom, nothing to bounce off there
+                ball.Velocity.y = -ball.Velocity.y;
+        }
+    });
+}
+
+static void benchParticles()
+{
+    const unsigned int UPDATES = 1000;
+    for (unsigned int amount : { 500u, 5000u })
+    {
+        ParticleGenerator particles(ShaderHandle{ 0 }, TextureView(), amount);
+        BallObject ball(glm::vec2(400.0f, 300.0f), 12.5f, glm::vec2(100.0f, -350.0f), TextureView());
+        ball.Stuck = false;
+        bench("ParticleGenerator::Update", std::to_string(amount), UPDATES, nullptr, [&]() {
+            for (unsigned int i = 0; i < UPDATES; i++)
+            {
+                ball.Move(1.0f / 120.0f, WIDTH);
+                particles.Update(1.0f / 120.0f, ball, 2, glm::vec2(ball.Radius / 2.0f));
+            }
+        });
+    }
+}
+
+static void benchLevels()
+{
+    for (const unsigned int *size : LEVEL_SIZES)
+    {
+        std::vector<unsigned char> tiles;
+        LevelData data = generateLevel(size[0], size[1], tiles);
+        unsigned int loads = std::max(1u, 100000u / (size[0] * size[1]));
+
+        GameLevel level;
+        bench("GameLevel::Load", sizeName(size[0], size[1]), loads, nullptr, [&]() {
+            for (unsigned int i = 0; i < loads; i++)
+                level.Load(data, WIDTH, HEIGHT / 2);
+        });
+
+        // play a bit, so Reset has bricks to restore; one Reset per sample, a second one has nothing left to do
+        bench("GameLevel::Reset", sizeName(size[0], size[1]), 1, [&]() {
+            for (unsigned int i = 0; i < level.Bricks.size(); i += 3)
+                level.Bricks[i].Destroyed = true;
+            for (LevelChunk &chunk : level.Chunks)
+                chunk.Version++;
+        }, [&]() {
+            level.Reset();
+        });
+    }
+}
+
+static void benchDoCollisions(Game &game)
+{
+    const unsigned int TICKS = 10000;
+    for (const unsigned int *size : LEVEL_SIZES)
+    {
+        std::vector<unsigned char> tiles;
+        LevelData data = generateLevel(size[0], size[1], tiles);
+        game.Levels[0].Load(data, WIDTH, HEIGHT / 2);
+        game.Level = 0;
+        game.ResetPlayer();
+
+        // ball dropped at random spots inside the level, most of them near or in bricks
+        glm::vec2 levelSize = game.Levels[0].Size;
+        std::vector<glm::vec2> positions(TICKS);
+        for (glm::vec2 &p : positions)
+            p = randomVec2(glm::vec2(0.0f), levelSize - Ball->Size);
+
+        bench("Game::DoCollisions", sizeName(size[0], size[1]), TICKS, [&]() {
+            game.ResetLevel();
+        }, [&]() {
+            for (const glm::vec2 &p : positions)
+            {
+                Ball->Position = p;
+                Ball->Velocity = glm::vec2(100.0f, -350.0f);
+                Ball->Stuck = false;
+                game.DoCollisions();
+            }
+        });
+    }
+}
+
+// building the overlay's vertices each frame (Draw is one upload and one draw call)
+static void benchOverlay()
+{
+    const unsigned int UPDATES = 1000;
+    OverlayRenderer overlay(ShaderHandle{ 0 });
+    for (unsigned int i = 0; i < 120; i++)
+        overlay.AddFrameTime(10.0f + i % 20);
+    OverlayStats stats = { 16.67f, 0.42f, 123, 456, 7890, 0.012f, true, 0, 0, 2.5f, 0.75f, false };
+    bench("OverlayRenderer::Update", "", UPDATES, nullptr, [&]() {
+        for (unsigned int i = 0; i < UPDATES; i++)
+        {
+            RenderArena.Swap(); // new frame, like main.cpp
+            overlay.Update(stats);
+        }
+    });
+}
+
+// full pool falling for one tick, paddle catching some (spawns refill what it removed)
+static void benchPowerUps()
+{
+    const unsigned int TICKS = 1000;
+    PowerUpPool pool;
+    std::vector<glm::vec2> positions(PowerUpPool::CAPACITY);
+    for (glm::vec2 &p : positions)
+        p = randomVec2(glm::vec2(0.0f), glm::vec2(WIDTH, HEIGHT));
+    bench("PowerUpPool::Update", "64", TICKS, nullptr, [&]() {
+        for (unsigned int t = 0; t < TICKS; t++)
+        {
+            for (unsigned int i = pool.Count; i < PowerUpPool::CAPACITY; i++)
+                pool.Spawn(static_cast<PowerUpType>(i % POWERUP_TYPES), positions[i]);
+            keep(pool.Update(1.0f / 120.0f, HEIGHT, glm::vec2(300.0f, 580.0f), glm::vec2(400.0f, 600.0f)));
+        }
+    });
+}
+
+// small allocations that live for a frame, arena vs heap
+static void benchFrameArena()
+{
+    const unsigned int ALLOCATIONS = 1000;
+    FrameArena arena("bench", ALLOCATIONS * 64);
+    bench("FrameArena::Allocate", "64 B", ALLOCATIONS, nullptr, [&]() {
+        arena.Reset();
+        for (unsigned int i = 0; i < ALLOCATIONS; i++)
+            keep(arena.Allocate(64));
+    });
+
+    std::vector<void*> blocks(ALLOCATIONS);
+    bench("operator new/delete", "64 B", ALLOCATIONS, nullptr, [&]() {
+        for (unsigned int i = 0; i < ALLOCATIONS; i++)
+            blocks[i] = ::operator new(64);
+        for (unsigned int i = 0; i < ALLOCATIONS; i++)
+            ::operator delete(blocks[i]);
+    });
+}
+
+// per tick: brick bits & delta into the rewind ring, a brick destroyed every tick; then rewinding all of it
+static void benchSnapshots()
+{
+    const unsigned int TICKS = 1200; // 10 s
+    for (const unsigned int *size : LEVEL_SIZES)
+    {
+        std::vector<unsigned char> tiles;
+        LevelData data = generateLevel(size[0], size[1], tiles);
+        GameLevel level;
+        level.Load(data, WIDTH, HEIGHT / 2);
+
+        SnapshotRing ring(8 * 1024 * 1024, TICKS + 1, 120);
+        BrickBits bits;
+        SimState sim;
+        std::memset(&sim, 0, sizeof(sim));
+        std::vector<unsigned char> state;
+        auto capture = [&](unsigned int tick) {
+            LevelChunk &chunk = level.Chunks[(tick * 31) % level.Chunks.size()];
+            if (chunk.Count > 0)
+            {
+                level.Bricks[chunk.First + tick % chunk.Count].Destroyed = true;
+                chunk.Version++;
+            }
+            bits.Update(level);
+            sim.Ball.Position = glm::vec2(tick, tick * 0.5f); // some state moves every tick
+            sim.ShakeTime = tick * 0.01f;
+            state.resize(sizeof(sim) + bits.Words.size() * sizeof(uint64_t));
+            std::memcpy(state.data(), &sim, sizeof(sim));
+            std::memcpy(state.data() + sizeof(sim), bits.Words.data(), bits.Words.size() * sizeof(uint64_t));
+            ring.Push(tick, state.data(), state.size());
+        };
+        auto record = [&]() {
+            level.Reset();
+            ring.Clear();
+            for (unsigned int t = 0; t < TICKS; t++)
+                capture(t);
+        };
+
+        bench("SnapshotRing::Push", sizeName(size[0], size[1]), TICKS, [&]() {
+            level.Reset();
+            ring.Clear();
+            capture(0); // after a reset every chunk is new to BrickBits, ticks after that aren't
+        }, [&]() {
+            for (unsigned int t = 1; t <= TICKS; t++)
+                capture(t);
+        });
+
+        std::vector<unsigned char> rewound;
+        uint64_t tick;
+        bench("SnapshotRing::Rewind", sizeName(size[0], size[1]) + " 10 s", 1, record, [&]() {
+            keep(ring.Rewind(TICKS - 1, rewound, tick));
+        });
+    }
+}
+
+// mixing every voice for one block, and what a sound costs the sim thread
+static void benchAudio()
+{
+    const unsigned int BLOCKS = 100;
+    AudioMixer mixer;
+    ClipHandle clip = mixer.AddClip("tone", AudioMixer::Tone(440.0f, 2.0f, 0.1f));
+    std::vector<float> mixed(AudioMixer::BLOCK_FRAMES * AudioSink::CHANNELS);
+    std::vector<int16_t> samples(mixed.size());
+    bench("AudioMixer::Mix", "32 voices", BLOCKS, [&]() {
+        for (unsigned int i = 0; i < AudioMixer::MAX_VOICES; i++)
+            mixer.Play(clip, 1.0f, i / 16.0f - 1.0f);
+        mixer.ApplyCommands();
+    }, [&]() {
+        for (unsigned int b = 0; b < BLOCKS; b++)
+        {
+            mixer.Mix(mixed.data(), AudioMixer::BLOCK_FRAMES);
+            AudioMixer::ToInt16(mixed.data(), samples.data(), mixed.size());
+        }
+        keep(samples[0]);
+    });
+
+    const unsigned int PLAYS = 200; // fits the queue
+    bench("AudioMixer::Play", "", PLAYS, [&]() {
+        mixer.ApplyCommands(); // empties the queue
+    }, [&]() {
+        for (unsigned int i = 0; i < PLAYS; i++)
+            mixer.Play(clip, 1.0f, 0.0f);
+    });
+}
+
+// one empty zone, in a disabled build this is just the loop
+static void benchProfiler()
+{
+    const unsigned int ZONES = 100000;
+    bench("PROFILE_ZONE", "", ZONES, nullptr, [&]() {
+        for (unsigned int i = 0; i < ZONES; i++)
+        {
+            PROFILE_ZONE("bench");
+            keep(i);
+        }
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    const char *jsonFile = "bin/bench.json";
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonFile = argv[++i];
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            Filter = argv[++i];
+        else if (std::strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+            REPETITIONS = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            std::cout << "usage: " << argv[0] << " [--json <file>] [--filter <substring>] [--reps <n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    useNullGL();
+    TextureCache::Enabled = false;
+    ResourceManager::LoadTexture("textures/awesomeface.png", true, "face");
+    ResourceManager::LoadTexture("textures/block.png", false, "block");
+    ResourceManager::LoadTexture("textures/block_solid.png", false, "block_solid");
+    ResourceManager::LoadTexture("textures/paddle.png", true, "paddle");
+
+    Game game(WIDTH, HEIGHT);
+    game.InitWorld();
+
+    std::printf("%u warmup, %u repetitions\n", WARMUP, REPETITIONS);
+    std::printf("%-44s %12s %12s %10s %12s\n", "benchmark", "median", "mean", "stddev", "min");
+
+    benchProfiler();
+    benchCollisionTests();
+    benchBall();
+    benchParticles();
+    benchLevels();
+    benchDoCollisions(game);
+    benchOverlay();
+    benchFrameArena();
+    benchPowerUps();
+    benchAudio();
+    benchSnapshots();
+
+    bool ok = writeJson(jsonFile);
+    if (ok)
+        std::cout << "results: " << jsonFile << std::endl;
+
+    game.Levels.clear();
+    ResourceManager::Clear();
+    return ok ? 0 : 1;
+}
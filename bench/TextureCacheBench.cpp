@@ -0,0 +1,118 @@
+/**
+ * Startup benchmark: cold vs warm texture loads through TextureCache.
+ *
+ * cold  = no cache file, image is decoded by stb_image
+ * write = writing the cache file for the decoded image (paid once, after a cold load)
+ * warm  = cache file exists, image is mmap'd
+ *
+ * Only the CPU side is measured (no OpenGL context), the glTexImage2D upload costs
+ * the same in both cases. Run from the repo root: ./bin/texture_cache_bench.exe
+ */
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+const char *TEXTURES[] = {
+    "textures/background.jpg",
+    "textures/awesomeface.png",
+    "textures/block.png",
+    "textures/block_solid.png",
+    "textures/paddle.png",
+    "textures/particle.png"
+};
+const unsigned int TEXTURE_COUNT = sizeof(TEXTURES) / sizeof(TEXTURES[0]);
+const unsigned int REPETITIONS = 20;
+
+double msSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// touch every page like the upload would, returns false if image didn't load
+bool touch(const DecodedImage &image)
+{
+    volatile unsigned int sum = 0;
+    size_t bytes = static_cast<size_t>(image.Width) * image.Height * image.Channels;
+    for (size_t b = 0; b < bytes; b += 4096)
+        sum += image.Data[b];
+    return bytes != 0;
+}
+
+/**
+ * Decodes all textures without the cache, then writes their cache files.
+ * Adds time in milliseconds of each part to coldMs and writeMs.
+ */
+void loadCold(double &coldMs, double &writeMs)
+{
+    for (unsigned int i = 0; i < TEXTURE_COUNT; i++)
+    {
+        std::remove(TextureCache::CachePath(TEXTURES[i]).c_str());
+
+        TextureCache::Enabled = false;
+        auto start = std::chrono::steady_clock::now();
+        DecodedImage image = TextureCache::Decode(TEXTURES[i]);
+        bool loaded = touch(image);
+        coldMs += msSince(start);
+        TextureCache::Enabled = true;
+
+        if (!loaded)
+        {
+            std::cout << "ERROR: failed to load image: " << TEXTURES[i] << std::endl;
+            continue;
+        }
+
+        start = std::chrono::steady_clock::now();
+        TextureCache::Store(TEXTURES[i], image);
+        writeMs += msSince(start);
+        TextureCache::Free(image);
+    }
+}
+
+/**
+ * Loads all textures from their cache files, returns time in milliseconds.
+ */
+double loadWarm()
+{
+    double total = 0.0;
+    for (unsigned int i = 0; i < TEXTURE_COUNT; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        DecodedImage image = TextureCache::Decode(TEXTURES[i]);
+        bool loaded = touch(image);
+        TextureCache::Free(image);
+        total += msSince(start);
+
+        if (!loaded)
+            std::cout << "ERROR: failed to load image: " << TEXTURES[i] << std::endl;
+    }
+    return total;
+}
+
+void report(const char *name, std::vector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    std::printf("%-6s min %8.3f ms   median %8.3f ms   max %8.3f ms\n", name, times.front(), times[times.size() / 2], times.back());
+}
+
+int main()
+{
+    std::vector<double> cold, write, warm;
+    for (unsigned int r = 0; r < REPETITIONS; r++)
+    {
+        double coldMs = 0.0, writeMs = 0.0;
+        loadCold(coldMs, writeMs);
+        cold.push_back(coldMs);
+        write.push_back(writeMs);
+        warm.push_back(loadWarm());
+    }
+
+    std::printf("%u textures, %u repetitions\n", TEXTURE_COUNT, REPETITIONS);
+    report("cold", cold);
+    report("write", write);
+    report("warm", warm);
+    return 0;
+}
@@ -0,0 +1,14 @@
+#version 330 core
+in vec2 TexCoord;
+in vec3 BrickColor;
+flat in float Solid;
+out vec4 color;
+
+uniform sampler2D block;
+uniform sampler2D solid;
+
+void main()
+{
+    vec4 texel = Solid > 0.5 ? texture(solid, TexCoord) : texture(block, TexCoord);
+    color = vec4(BrickColor, 1.0) * texel;
+}
\ No newline at end of file
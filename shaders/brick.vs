@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 texCoord>
+layout (location = 1) in vec4 rect;   // per brick: <vec2 position, vec2 size>
+layout (location = 2) in vec4 brick;  // per brick: <vec3 color, solid>
+
+out vec2 TexCoord;
+out vec3 BrickColor;
+flat out float Solid;
+
+uniform mat4 projection;
+
+void main()
+{
+    TexCoord = vertex.zw;
+    BrickColor = brick.rgb;
+    Solid = brick.a;
+    gl_Position = projection * vec4(rect.xy + vertex.xy * rect.zw, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 330 core
+in vec2 TexCoord;
+in vec4 Color;
+out vec4 color;
+
+uniform sampler2D atlas; // single channel, glyph coverage
+
+void main()
+{
+    color = vec4(Color.rgb, Color.a * texture(atlas, TexCoord).r);
+}
\ No newline at end of file
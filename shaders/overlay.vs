@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 texCoord>
+layout (location = 1) in vec4 color;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+uniform mat4 projection;
+
+void main()
+{
+    TexCoord = vertex.zw;
+    Color = color;
+    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+}
\ No newline at end of file
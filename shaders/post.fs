@@ -0,0 +1,60 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D scene;
+
+uniform bool chaos;
+uniform bool confuse;
+uniform bool shake;
+uniform float flash;
+
+const float edge_kernel[9] = float[](
+    -1.0, -1.0, -1.0,
+    -1.0,  8.0, -1.0,
+    -1.0, -1.0, -1.0
+);
+const float blur_kernel[9] = float[](
+    1.0 / 16.0, 2.0 / 16.0, 1.0 / 16.0,
+    2.0 / 16.0, 4.0 / 16.0, 2.0 / 16.0,
+    1.0 / 16.0, 2.0 / 16.0, 1.0 / 16.0
+);
+
+// scene texture clamps at its edges, chaos scrolls past them so it wraps here
+vec3 sampleScene(vec2 uv)
+{
+    return texture(scene, chaos ? fract(uv) : uv).rgb;
+}
+
+void main()
+{
+    // 3x3 neighbourhood, a few pixels apart whatever the buffer size
+    vec2 offset = 2.5 / vec2(textureSize(scene, 0));
+    vec3 samples[9];
+    if (chaos || shake)
+    {
+        for (int i = 0; i < 9; i++)
+            samples[i] = sampleScene(TexCoords + vec2(i % 3 - 1, 1 - i / 3) * offset);
+    }
+
+    vec3 result = vec3(0.0);
+    if (chaos)
+    {
+        for (int i = 0; i < 9; i++)
+            result += samples[i] * edge_kernel[i];
+    }
+    else if (confuse)
+    {
+        result = 1.0 - sampleScene(TexCoords);
+    }
+    else if (shake)
+    {
+        for (int i = 0; i < 9; i++)
+            result += samples[i] * blur_kernel[i];
+    }
+    else
+    {
+        result = sampleScene(TexCoords);
+    }
+    color = vec4(mix(result, vec3(1.0), flash), 1.0);
+}
\ No newline at end of file
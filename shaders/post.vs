@@ -0,0 +1,32 @@
+#version 330 core
+out vec2 TexCoords;
+
+uniform bool chaos;
+uniform bool confuse;
+uniform bool shake;
+uniform float time;
+
+void main()
+{
+    // one triangle covering the screen: (0, 0), (2, 0), (0, 2) in texture space
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+
+    vec2 uv = position;
+    if (chaos)
+    {
+        float strength = 0.3;
+        uv += vec2(sin(time), cos(time)) * strength;
+    }
+    else if (confuse)
+    {
+        uv = vec2(1.0) - uv;
+    }
+    TexCoords = uv;
+
+    if (shake)
+    {
+        float strength = 0.01;
+        gl_Position.xy += vec2(cos(time * 10.0), cos(time * 15.0)) * strength;
+    }
+}
\ No newline at end of file
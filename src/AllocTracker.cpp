@@ -0,0 +1,161 @@
+#include "AllocTracker.h"
+
+#ifdef ENABLE_ALLOC_TRACKER
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include <execinfo.h>
+#include <unistd.h>
+
+thread_local ThreadAllocState ThreadAllocs = {};
+
+bool AllocTracker::AssertSteady = std::getenv("BREAKOUT_ALLOC_ASSERT") != nullptr && std::strcmp(std::getenv("BREAKOUT_ALLOC_ASSERT"), "0") != 0;
+
+const std::chrono::seconds ALLOC_LOG_INTERVAL(5);
+
+// SteadyFrame bookkeeping of one thread
+struct ThreadFrameState
+{
+    const char *Thread;
+    unsigned int SinceUnsteady; // frames since last MarkUnsteady
+    uint64_t LastFrame;         // allocations of previous frame
+    // log window
+    unsigned int Frames, SteadyFrames, SteadyFramesAllocating;
+    uint64_t Count, Bytes, MaxPerFrame;
+    std::chrono::steady_clock::time_point WindowStart;
+};
+static thread_local ThreadFrameState FrameState = {};
+
+/**
+ * Inside a steady frame with asserts on. Only write(), backtrace_symbols_fd()
+ * and abort() from here, they don't allocate.
+ */
+static void steadyAllocation(size_t size)
+{
+    ThreadAllocs.InSteadyFrame = false; // backtrace() may allocate the first time
+    char message[160];
+    int length = std::snprintf(message, sizeof(message), "ERROR: heap allocation of %zu bytes in steady %s frame\n",
+                               size, FrameState.Thread != nullptr ? FrameState.Thread : "?");
+    if (write(STDOUT_FILENO, message, length) < 0)
+        _exit(1);
+
+    void *frames[32];
+    int depth = backtrace(frames, 32);
+    backtrace_symbols_fd(frames, depth, STDOUT_FILENO);
+    std::abort();
+}
+
+static void* allocate(size_t size, size_t alignment)
+{
+    ThreadAllocState &state = ThreadAllocs;
+    state.Total.Count++;
+    state.Total.Bytes += size;
+    if (state.InSteadyFrame && AllocTracker::AssertSteady)
+        steadyAllocation(size);
+
+    if (size == 0)
+        size = 1;
+    if (alignment <= alignof(std::max_align_t))
+        return std::malloc(size);
+
+    void *memory = nullptr;
+    return posix_memalign(&memory, alignment, size) == 0 ? memory : nullptr;
+}
+
+static void* allocateOrThrow(size_t size, size_t alignment)
+{
+    void *memory = allocate(size, alignment);
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    return memory;
+}
+
+// replacements for every global operator new/delete, memory comes from malloc
+void* operator new(size_t size) { return allocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return allocateOrThrow(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void *memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+
+SteadyFrame::SteadyFrame(const char *thread)
+    : thread(thread), start(ThreadAllocs.Total)
+{
+    ThreadFrameState &state = FrameState;
+    if (state.Thread == nullptr)
+    {
+        state.Thread = thread;
+        state.WindowStart = std::chrono::steady_clock::now();
+    }
+    ThreadAllocs.InSteadyFrame = state.SinceUnsteady >= WARMUP_FRAMES;
+}
+
+/**
+ * Adds frame to the log window, logs once per ALLOC_LOG_INTERVAL.
+ */
+SteadyFrame::~SteadyFrame()
+{
+    ThreadFrameState &state = FrameState;
+    bool steady = ThreadAllocs.InSteadyFrame;
+    ThreadAllocs.InSteadyFrame = false;
+
+    uint64_t count = ThreadAllocs.Total.Count - this->start.Count;
+    state.LastFrame = count;
+    state.SinceUnsteady++;
+    state.Frames++;
+    state.Count += count;
+    state.Bytes += ThreadAllocs.Total.Bytes - this->start.Bytes;
+    if (count > state.MaxPerFrame)
+        state.MaxPerFrame = count;
+    if (steady)
+    {
+        state.SteadyFrames++;
+        if (count > 0)
+            state.SteadyFramesAllocating++;
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - state.WindowStart >= ALLOC_LOG_INTERVAL)
+    {
+        std::cout << "ALLOC: " << this->thread << " " << state.Frames << " frames, " << state.Count << " allocations ("
+            << state.Bytes << " bytes), max " << state.MaxPerFrame << " per frame, "
+            << state.SteadyFramesAllocating << " of " << state.SteadyFrames << " steady frames allocated" << std::endl;
+        state.Frames = state.SteadyFrames = state.SteadyFramesAllocating = 0;
+        state.Count = state.Bytes = state.MaxPerFrame = 0;
+        state.WindowStart = now;
+    }
+}
+
+void SteadyFrame::MarkUnsteady()
+{
+    ThreadAllocs.InSteadyFrame = false;
+    FrameState.SinceUnsteady = 0;
+}
+
+uint64_t SteadyFrame::LastFrameAllocations()
+{
+    return FrameState.LastFrame;
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstdint>
+
+/**
+ * Counts heap allocations per thread, per frame and (with the profiler) per
+ * PROFILE_ZONE. Only compiled in with -DENABLE_ALLOC_TRACKER (make ALLOC_TRACK=1),
+ * which replaces the global operator new. Otherwise everything here is empty.
+ *
+ * Frames are marked with a SteadyFrame scope (sim tick, rendered frame). A frame
+ * counts as steady once WARMUP_FRAMES frames in a row went by without
+ * SteadyFrame::MarkUnsteady() (level loads, hot reloads). Steady frames are
+ * expected not to allocate: each thread logs its allocations per frame every
+ * few seconds, and with BREAKOUT_ALLOC_ASSERT=1 in the environment the first
+ * allocation inside a steady frame aborts with a message and a backtrace.
+ *
+ * Allocations made by the OpenGL driver inside GL calls on the render thread
+ * are counted too, they can't be told apart from ours.
+ */
+
+struct AllocStats
+{
+    uint64_t Count;
+    uint64_t Bytes;
+};
+
+#ifdef ENABLE_ALLOC_TRACKER
+
+// calling thread's counters, updated by operator new
+struct ThreadAllocState
+{
+    AllocStats Total;
+    bool InSteadyFrame;
+};
+extern thread_local ThreadAllocState ThreadAllocs;
+
+class AllocTracker
+{
+    public:
+        static constexpr bool Enabled = true;
+        static AllocStats Thread() { return ThreadAllocs.Total; } // totals of calling thread
+        static bool AssertSteady; // abort on allocation in a steady frame, from BREAKOUT_ALLOC_ASSERT
+
+    private:
+        AllocTracker();
+};
+
+// One frame of a thread's loop, see above. One per thread at a time.
+class SteadyFrame
+{
+    public:
+        static const unsigned int WARMUP_FRAMES = 120;
+
+        explicit SteadyFrame(const char *thread);
+        ~SteadyFrame();
+
+        SteadyFrame(const SteadyFrame&) = delete;
+        SteadyFrame& operator=(const SteadyFrame&) = delete;
+
+        static void MarkUnsteady(); // this frame (and warmup after it) may allocate, call before allocating
+        static uint64_t LastFrameAllocations(); // calling thread's previous frame
+
+    private:
+        const char *thread;
+        AllocStats start;
+};
+
+#else
+
+class AllocTracker
+{
+    public:
+        static constexpr bool Enabled = false;
+        static AllocStats Thread() { return AllocStats{ 0, 0 }; }
+};
+
+class SteadyFrame
+{
+    public:
+        explicit SteadyFrame(const char*) { }
+        static void MarkUnsteady() { }
+        static uint64_t LastFrameAllocations() { return 0; }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,135 @@
+#include "AssetPack.h"
+
+#include <iostream>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(sizeof(PackHeader) == 16, "unexpected pack header size");
+static_assert(sizeof(PackEntry) == 96, "unexpected pack entry size");
+
+AssetPack::AssetPack()
+    : mapping(nullptr), mappingSize(0), entries(nullptr), entryCount(0)
+{
+}
+
+AssetPack::~AssetPack()
+{
+    this->Close();
+}
+
+/**
+ * Blob lies inside the file and is what its type says: loaders hand texture
+ * blobs straight to OpenGL and use shader blobs as C strings.
+ */
+static bool validEntry(const PackEntry &entry, const unsigned char *base, size_t size)
+{
+    if (entry.Offset > size || entry.Size > size - entry.Offset || entry.Name[PACK_NAME_LENGTH - 1] != '\0')
+        return false;
+
+    switch (entry.Type)
+    {
+        case PACK_SHADER:
+            return entry.Size > 0 && base[entry.Offset + entry.Size - 1] == '\0';
+        case PACK_TEXTURE:
+            // Width * Height can't overflow 64 bits; once it's no bigger than Size, times Channels can't either
+            return (entry.Channels == 3 || entry.Channels == 4)
+                && static_cast<uint64_t>(entry.Width) * entry.Height <= entry.Size
+                && static_cast<uint64_t>(entry.Width) * entry.Height * entry.Channels == entry.Size;
+        case PACK_LEVEL:
+            return true; // checked by LevelFile::Parse
+        default:
+            return false;
+    }
+}
+
+bool AssetPack::Open(const char *file)
+{
+    this->Close();
+
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+        return false; // no pack is fine, assets come from the file system then
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PackHeader)))
+    {
+        std::cout << "ERROR: not an asset pack: " << file << std::endl;
+        close(fd);
+        return false;
+    }
+
+    void *base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // mapping stays valid
+    if (base == MAP_FAILED)
+    {
+        std::cout << "ERROR: could not map file: " << file << std::endl;
+        return false;
+    }
+
+    const PackHeader *header = static_cast<const PackHeader*>(base);
+    const PackEntry *entries = reinterpret_cast<const PackEntry*>(header + 1);
+    size_t size = st.st_size;
+
+    bool valid = std::memcmp(header->Magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0
+        && header->Version == PACK_VERSION
+        && sizeof(PackHeader) + static_cast<size_t>(header->EntryCount) * sizeof(PackEntry) <= size;
+    for (uint32_t i = 0; valid && i < header->EntryCount; i++)
+        valid = validEntry(entries[i], static_cast<const unsigned char*>(base), size);
+    if (!valid)
+    {
+        std::cout << "ERROR: corrupt asset pack: " << file << std::endl;
+        munmap(base, size);
+        return false;
+    }
+
+    this->mapping = base;
+    this->mappingSize = size;
+    this->entries = entries;
+    this->entryCount = header->EntryCount;
+    return true;
+}
+
+void AssetPack::Close()
+{
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->mappingSize);
+
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->entries = nullptr;
+    this->entryCount = 0;
+}
+
+bool AssetPack::IsOpen() const
+{
+    return this->mapping != nullptr;
+}
+
+/**
+ * Binary search, entries are sorted by name.
+ */
+const PackEntry* AssetPack::Find(const char *name, PackEntryType type) const
+{
+    uint32_t low = 0, high = this->entryCount;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        int order = std::strcmp(this->entries[middle].Name, name);
+        if (order == 0)
+            return this->entries[middle].Type == static_cast<uint32_t>(type) ? &this->entries[middle] : nullptr;
+        else if (order < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return nullptr;
+}
+
+const unsigned char* AssetPack::Data(const PackEntry &entry) const
+{
+    return static_cast<const unsigned char*>(this->mapping) + entry.Offset;
+}
@@ -0,0 +1,73 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Asset pack (.pak): every asset the game needs in one file.
+ *
+ *   PackHeader
+ *   PackEntry x EntryCount, sorted by name
+ *   blobs, each starting on a PACK_ALIGNMENT boundary
+ *
+ * Entries are named by the path the asset would be loaded from ("shaders/sprite.vs"),
+ * so loaders can ask the pack first and fall back to the file system. Blobs are stored
+ * ready to use: shader source (zero terminated), decoded pixels, .blvl level data.
+ */
+const char PACK_MAGIC[4] = { 'B', 'P', 'A', 'K' };
+const uint32_t PACK_VERSION = 1;
+const uint32_t PACK_ALIGNMENT = 64;
+const unsigned int PACK_NAME_LENGTH = 64;
+
+enum PackEntryType
+{
+    PACK_SHADER,
+    PACK_TEXTURE,
+    PACK_LEVEL
+};
+
+struct PackHeader
+{
+    char Magic[4];          // PACK_MAGIC
+    uint32_t Version;
+    uint32_t EntryCount;
+    uint32_t Reserved;
+};
+
+struct PackEntry
+{
+    char Name[PACK_NAME_LENGTH]; // zero terminated
+    uint32_t Type;          // PackEntryType
+    uint32_t Width, Height; // textures only
+    uint32_t Channels;      // textures only
+    uint64_t Offset;        // from start of file
+    uint64_t Size;          // shaders: including terminating zero
+};
+
+// A memory-mapped asset pack, mapped once and read in place
+class AssetPack
+{
+    public:
+        AssetPack();
+        ~AssetPack();
+
+        bool Open(const char *file); // prints error on failure
+        void Close();
+        bool IsOpen() const;
+
+        // nullptr if pack has no entry with that name (or pack isn't open)
+        const PackEntry* Find(const char *name, PackEntryType type) const;
+        const unsigned char* Data(const PackEntry &entry) const;
+
+    private:
+        void *mapping;
+        size_t mappingSize;
+        const PackEntry *entries;
+        uint32_t entryCount;
+
+        AssetPack(const AssetPack&);
+        AssetPack& operator=(const AssetPack&);
+};
+
+#endif
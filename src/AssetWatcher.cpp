@@ -0,0 +1,95 @@
+#include "AssetWatcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+const int POLL_TIMEOUT_MS = 100; // how quickly the thread notices it should stop
+
+AssetWatcher::AssetWatcher(const std::vector<std::string> &directories)
+    : inotifyFd(-1), running(false)
+{
+    this->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->inotifyFd < 0)
+    {
+        std::cout << "ERROR: could not start asset watcher (inotify_init1 failed)" << std::endl;
+        return;
+    }
+
+    for (const std::string &directory : directories)
+    {
+        // close-write: file saved in place, moved-to: editors that save by renaming a temp file
+        int watch = inotify_add_watch(this->inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watch < 0)
+        {
+            std::cout << "ERROR: could not watch directory: " << directory << std::endl;
+            continue;
+        }
+        this->watches.push_back(watch);
+        this->directories.push_back(directory);
+    }
+
+    this->running = true;
+    this->thread = std::thread(&AssetWatcher::run, this);
+}
+
+AssetWatcher::~AssetWatcher()
+{
+    this->running = false;
+    if (this->thread.joinable())
+        this->thread.join();
+
+    if (this->inotifyFd >= 0)
+        close(this->inotifyFd);
+}
+
+std::vector<std::string> AssetWatcher::TakeChanged()
+{
+    std::vector<std::string> result;
+
+    // never stall the frame, if watcher thread holds the lock just try again next frame
+    std::unique_lock<std::mutex> lock(this->changedMutex, std::try_to_lock);
+    if (lock.owns_lock())
+        result.swap(this->changed);
+    return result;
+}
+
+void AssetWatcher::run()
+{
+    // aligned as inotify_event requires
+    alignas(struct inotify_event) char buffer[4096];
+    struct pollfd pfd = { this->inotifyFd, POLLIN, 0 };
+
+    while (this->running)
+    {
+        if (poll(&pfd, 1, POLL_TIMEOUT_MS) <= 0)
+            continue;
+
+        ssize_t length = read(this->inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0)
+            continue;
+
+        for (char *ptr = buffer; ptr < buffer + length; )
+        {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0)
+                continue;
+
+            auto watch = std::find(this->watches.begin(), this->watches.end(), event->wd);
+            if (watch == this->watches.end())
+                continue;
+
+            std::string file = this->directories[watch - this->watches.begin()] + "/" + event->name;
+
+            // editors often write a file several times in a row, only report it once
+            std::lock_guard<std::mutex> lock(this->changedMutex);
+            if (std::find(this->changed.begin(), this->changed.end(), file) == this->changed.end())
+                this->changed.push_back(file);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef ASSET_WATCHER_H
+#define ASSET_WATCHER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Watches asset directories with inotify on a background thread.
+ *
+ * Changed files are reported as "<directory>/<file name>", the same relative paths
+ * used to load assets. The game collects them once per frame with TakeChanged() and
+ * reloads them on the OpenGL thread.
+ */
+class AssetWatcher
+{
+    public:
+        AssetWatcher(const std::vector<std::string> &directories);
+        ~AssetWatcher();
+
+        // files written since last call, each file at most once
+        std::vector<std::string> TakeChanged();
+
+    private:
+        int inotifyFd;
+        std::vector<int> watches;
+        std::vector<std::string> directories; // same index as watches
+
+        std::thread thread;
+        std::atomic<bool> running;
+
+        std::mutex changedMutex;
+        std::vector<std::string> changed;
+
+        void run();
+
+        AssetWatcher(const AssetWatcher&);
+        AssetWatcher& operator=(const AssetWatcher&);
+};
+
+#endif
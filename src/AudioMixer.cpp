@@ -0,0 +1,278 @@
+#include "AudioMixer.h"
+#include "AllocTracker.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+AudioMixer::AudioMixer()
+    : voices(), sink(nullptr), running(false)
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+    this->Stop();
+}
+
+static uint32_t readU32(const unsigned char *in) { return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24); }
+static uint16_t readU16(const unsigned char *in) { return in[0] | (in[1] << 8); }
+
+/**
+ * Reads the fmt and data chunks, anything else in the file is skipped. Stereo
+ * is mixed down to mono, voices are panned by the mixer.
+ */
+ClipHandle AudioMixer::LoadClip(const char *file, const std::string &name)
+{
+    std::ifstream stream(file, std::ios::binary);
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    std::vector<float> samples;
+
+    unsigned int channels = 0, bits = 0, rate = 0;
+    bool valid = bytes.size() >= 12 && std::memcmp(bytes.data(), "RIFF", 4) == 0 && std::memcmp(bytes.data() + 8, "WAVE", 4) == 0;
+    size_t offset = 12;
+    while (valid && offset + 8 <= bytes.size())
+    {
+        const unsigned char *chunk = bytes.data() + offset;
+        size_t size = std::min<size_t>(readU32(chunk + 4), bytes.size() - offset - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16)
+        {
+            valid = readU16(chunk + 8) == 1; // PCM
+            channels = readU16(chunk + 10);
+            rate = readU32(chunk + 12);
+            bits = readU16(chunk + 22);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0 && channels > 0 && (bits == 8 || bits == 16))
+        {
+            unsigned int frameBytes = channels * bits / 8;
+            size_t frames = size / frameBytes;
+            samples.resize(frames);
+            for (size_t i = 0; i < frames; i++)
+            {
+                float sum = 0.0f;
+                for (unsigned int c = 0; c < channels; c++)
+                {
+                    const unsigned char *sample = chunk + 8 + i * frameBytes + c * bits / 8;
+                    sum += bits == 8 ? (sample[0] - 128) / 128.0f : static_cast<int16_t>(readU16(sample)) / 32768.0f;
+                }
+                samples[i] = sum / channels;
+            }
+        }
+        offset += 8 + size + (size & 1); // chunks are word aligned
+    }
+
+    if (!valid || samples.empty())
+        std::cout << "ERROR::AUDIO: Failed to read clip (8/16 bit PCM wav expected): " << file << std::endl;
+    else if (rate != AudioSink::SAMPLE_RATE)
+        std::cout << "ERROR::AUDIO: " << file << " is " << rate << " Hz, plays at " << AudioSink::SAMPLE_RATE << " Hz" << std::endl;
+    return this->AddClip(name, std::move(samples)); // empty clip plays silence, handle stays usable
+}
+
+ClipHandle AudioMixer::AddClip(const std::string &name, std::vector<float> samples)
+{
+    samples.resize((samples.size() + 3) / 4 * 4, 0.0f);
+    this->clips.push_back(AudioClip{ name, std::move(samples) });
+    return ClipHandle{ static_cast<unsigned int>(this->clips.size() - 1) };
+}
+
+std::vector<float> AudioMixer::Tone(float frequency, float seconds, float volume)
+{
+    std::vector<float> samples(static_cast<size_t>(seconds * AudioSink::SAMPLE_RATE));
+    float period = AudioSink::SAMPLE_RATE / frequency;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        float envelope = std::exp(-5.0f * i / samples.size());
+        samples[i] = (std::fmod(static_cast<float>(i), period) < period / 2.0f ? volume : -volume) * envelope;
+    }
+    return samples;
+}
+
+void AudioMixer::Start(AudioSink *sink)
+{
+    this->sink = sink;
+    this->running.store(true, std::memory_order_release);
+    this->thread = std::thread(&AudioMixer::run, this);
+}
+
+void AudioMixer::Stop()
+{
+    this->running.store(false, std::memory_order_release);
+    if (this->thread.joinable())
+        this->thread.join();
+}
+
+void AudioMixer::Play(ClipHandle clip, float volume, float pan)
+{
+    this->push(AudioCommand{ AUDIO_PLAY, clip.Index, volume, pan });
+}
+
+void AudioMixer::StopClip(ClipHandle clip)
+{
+    this->push(AudioCommand{ AUDIO_STOP_CLIP, clip.Index, 0.0f, 0.0f });
+}
+
+void AudioMixer::StopAll()
+{
+    this->push(AudioCommand{ AUDIO_STOP_ALL, 0, 0.0f, 0.0f });
+}
+
+void AudioMixer::push(const AudioCommand &command)
+{
+    this->commands.Push(command); // full: dropped, a missing blip beats a stalled tick
+}
+
+/**
+ * Mixer thread: commands, then one block into the sink. Sinks that don't block
+ * get blocks at the rate they would be played.
+ */
+void AudioMixer::run()
+{
+    typedef std::chrono::steady_clock clock;
+    const clock::duration block = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(static_cast<double>(BLOCK_FRAMES) / AudioSink::SAMPLE_RATE));
+
+    PROFILE_THREAD("audio");
+    float mixed[BLOCK_FRAMES * AudioSink::CHANNELS];
+    int16_t samples[BLOCK_FRAMES * AudioSink::CHANNELS];
+    clock::time_point next = clock::now();
+    while (this->running.load(std::memory_order_acquire))
+    {
+        {
+            SteadyFrame frame("audio");
+            this->ApplyCommands();
+            this->Mix(mixed, BLOCK_FRAMES);
+            ToInt16(mixed, samples, BLOCK_FRAMES * AudioSink::CHANNELS);
+            if (!this->sink->Write(samples, BLOCK_FRAMES))
+            {
+                std::cout << "ERROR::AUDIO: Output failed, mixer stopped" << std::endl;
+                return;
+            }
+        }
+
+        if (!this->sink->Blocking())
+        {
+            next += block;
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
+
+void AudioMixer::ApplyCommands()
+{
+    const AudioCommand *command;
+    while ((command = this->commands.Front()) != nullptr)
+    {
+        if (command->Type == AUDIO_PLAY)
+            this->play(*command);
+        for (Voice &voice : this->voices)
+        {
+            if (command->Type == AUDIO_STOP_ALL || (command->Type == AUDIO_STOP_CLIP && voice.Clip == command->Clip))
+                voice.Playing = false;
+        }
+        this->commands.Pop();
+    }
+}
+
+void AudioMixer::play(const AudioCommand &command)
+{
+    if (command.Clip >= this->clips.size())
+        return;
+
+    // free voice, or the one closest to its end
+    Voice *target = &this->voices[0];
+    unsigned int targetLeft = ~0u;
+    for (Voice &voice : this->voices)
+    {
+        if (!voice.Playing)
+        {
+            target = &voice;
+            break;
+        }
+        unsigned int left = this->clips[voice.Clip].Samples.size() - voice.Position;
+        if (left < targetLeft)
+        {
+            target = &voice;
+            targetLeft = left;
+        }
+    }
+
+    // constant power pan
+    float angle = (std::clamp(command.Pan, -1.0f, 1.0f) + 1.0f) * 0.25f * 3.14159265f;
+    target->Clip = command.Clip;
+    target->Position = 0;
+    target->GainLeft = command.Volume * std::cos(angle);
+    target->GainRight = command.Volume * std::sin(angle);
+    target->Playing = true;
+}
+
+// adds count mono samples to interleaved stereo out
+static void mixVoice(float *out, const float *in, unsigned int count, float left, float right)
+{
+    unsigned int i = 0;
+#if defined(__SSE2__)
+    __m128 gains = _mm_setr_ps(left, right, left, right);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 mono = _mm_loadu_ps(in + i);           // s0 s1 s2 s3
+        __m128 low = _mm_unpacklo_ps(mono, mono);     // s0 s0 s1 s1
+        __m128 high = _mm_unpackhi_ps(mono, mono);    // s2 s2 s3 s3
+        float *o = out + 2 * i;
+        _mm_storeu_ps(o, _mm_add_ps(_mm_loadu_ps(o), _mm_mul_ps(low, gains)));
+        _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_mul_ps(high, gains)));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        out[2 * i] += in[i] * left;
+        out[2 * i + 1] += in[i] * right;
+    }
+}
+
+void AudioMixer::Mix(float *out, unsigned int frames)
+{
+    PROFILE_ZONE("AudioMixer::Mix");
+    std::fill(out, out + frames * AudioSink::CHANNELS, 0.0f);
+    for (Voice &voice : this->voices)
+    {
+        if (!voice.Playing)
+            continue;
+        const std::vector<float> &samples = this->clips[voice.Clip].Samples;
+        unsigned int count = std::min<size_t>(frames, samples.size() - voice.Position);
+        mixVoice(out, samples.data() + voice.Position, count, voice.GainLeft, voice.GainRight);
+        voice.Position += count;
+        if (voice.Position >= samples.size())
+            voice.Playing = false;
+    }
+}
+
+void AudioMixer::ToInt16(const float *in, int16_t *out, unsigned int samples)
+{
+    unsigned int i = 0;
+#if defined(__SSE2__)
+    __m128 scale = _mm_set1_ps(32767.0f), low = _mm_set1_ps(-1.0f), high = _mm_set1_ps(1.0f);
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), low), high), scale));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), low), high), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(a, b));
+    }
+#endif
+    for (; i < samples; i++)
+        out[i] = static_cast<int16_t>(std::lrint(std::clamp(in[i], -1.0f, 1.0f) * 32767.0f));
+}
+
+unsigned int AudioMixer::ActiveVoices() const
+{
+    unsigned int active = 0;
+    for (const Voice &voice : this->voices)
+        active += voice.Playing;
+    return active;
+}
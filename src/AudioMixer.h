@@ -0,0 +1,103 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioSink.h"
+#include "SpscQueue.h"
+
+// Index of a clip loaded into an AudioMixer
+struct ClipHandle
+{
+    unsigned int Index;
+};
+
+// Mono float samples at AudioSink::SAMPLE_RATE, kept in memory for good
+struct AudioClip
+{
+    std::string Name;
+    std::vector<float> Samples; // padded with silence to a multiple of 4, for the SIMD mix
+};
+
+enum AudioCommandType
+{
+    AUDIO_PLAY,
+    AUDIO_STOP_CLIP,
+    AUDIO_STOP_ALL
+};
+
+struct AudioCommand
+{
+    AudioCommandType Type;
+    unsigned int Clip;
+    float Volume, Pan; // pan -1 (left) to 1 (right)
+};
+
+/**
+ * Software mixer on its own thread. Game code only pushes commands into a
+ * lock-free queue (Play/Stop never block or allocate, a full queue drops the
+ * command), the mixer thread picks them up before every block it mixes.
+ *
+ * Clips are loaded before Start and never change afterwards, so the mixer
+ * thread reads them without locks. Voices are a fixed array; when all are busy
+ * a new sound replaces the one closest to finishing.
+ */
+class AudioMixer
+{
+    public:
+        static const unsigned int MAX_VOICES = 32;
+        static const unsigned int BLOCK_FRAMES = 512; // per mix, ~12 ms
+
+        AudioMixer();
+        ~AudioMixer();
+
+        // before Start only
+        ClipHandle LoadClip(const char *file, const std::string &name); // 8/16 bit PCM .wav, mono or stereo, 44.1 kHz
+        ClipHandle AddClip(const std::string &name, std::vector<float> samples); // e.g. from Tone
+        static std::vector<float> Tone(float frequency, float seconds, float volume); // square blip with decay
+
+        void Start(AudioSink *sink); // sink must outlive Stop
+        void Stop();
+
+        // one producer thread (the sim thread), a single queue push each
+        void Play(ClipHandle clip, float volume = 1.0f, float pan = 0.0f);
+        void StopClip(ClipHandle clip); // every voice playing it
+        void StopAll();
+
+        // mixes frames of stereo into out (interleaved), called by the mixer thread, public for benchmarks
+        void Mix(float *out, unsigned int frames);
+        void ApplyCommands();
+        static void ToInt16(const float *in, int16_t *out, unsigned int samples); // clamps
+
+        unsigned int ActiveVoices() const;
+
+    private:
+        struct Voice
+        {
+            unsigned int Clip;
+            unsigned int Position; // next sample
+            float GainLeft, GainRight;
+            bool Playing;
+        };
+
+        std::vector<AudioClip> clips;
+        Voice voices[MAX_VOICES];
+        SpscQueue<AudioCommand, 256> commands;
+
+        AudioSink *sink;
+        std::thread thread;
+        std::atomic<bool> running;
+
+        void run();
+        void play(const AudioCommand &command);
+        void push(const AudioCommand &command);
+
+        AudioMixer(const AudioMixer&);
+        AudioMixer& operator=(const AudioMixer&);
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "AudioSink.h"
+
+#include <iostream>
+
+WavSink::WavSink(const std::string &file)
+    : file(std::fopen(file.c_str(), "wb")), dataBytes(0)
+{
+    if (this->file == nullptr)
+    {
+        std::cout << "ERROR::AUDIO: Failed to open " << file << " for writing" << std::endl;
+        return;
+    }
+    this->writeHeader(); // placeholder sizes until done
+}
+
+WavSink::~WavSink()
+{
+    if (this->file == nullptr)
+        return;
+    std::fseek(this->file, 0, SEEK_SET);
+    this->writeHeader();
+    std::fclose(this->file);
+}
+
+bool WavSink::Write(const int16_t *samples, unsigned int frames)
+{
+    if (this->file == nullptr)
+        return false;
+    size_t count = frames * CHANNELS;
+    if (std::fwrite(samples, sizeof(int16_t), count, this->file) != count) // wav is little endian, so is every host we build for
+    {
+        std::cout << "ERROR::AUDIO: Failed writing wav file" << std::endl;
+        return false;
+    }
+    this->dataBytes += count * sizeof(int16_t);
+    return true;
+}
+
+static void putU32(unsigned char *out, uint32_t value)
+{
+    for (unsigned int i = 0; i < 4; i++)
+        out[i] = (value >> (8 * i)) & 0xFF;
+}
+
+static void putU16(unsigned char *out, uint16_t value)
+{
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+// canonical 44 byte PCM header
+void WavSink::writeHeader()
+{
+    unsigned char header[44] = { 'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' };
+    putU32(header + 4, 36 + this->dataBytes);
+    putU32(header + 16, 16);                           // fmt chunk size
+    putU16(header + 20, 1);                            // PCM
+    putU16(header + 22, CHANNELS);
+    putU32(header + 24, SAMPLE_RATE);
+    putU32(header + 28, SAMPLE_RATE * CHANNELS * 2);   // bytes per second
+    putU16(header + 32, CHANNELS * 2);                 // bytes per frame
+    putU16(header + 34, 16);                           // bits per sample
+    header[36] = 'd'; header[37] = 'a'; header[38] = 't'; header[39] = 'a';
+    putU32(header + 40, this->dataBytes);
+    std::fwrite(header, 1, sizeof(header), this->file);
+}
@@ -0,0 +1,56 @@
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * Where AudioMixer's output goes: 16 bit signed stereo, interleaved, at
+ * AudioSink::SAMPLE_RATE. Called from the mixer thread only. A sink that talks
+ * to a device blocks in Write until the device wants more, the ones here
+ * don't, so the mixer paces itself (see Blocking).
+ */
+class AudioSink
+{
+    public:
+        static const unsigned int SAMPLE_RATE = 44100;
+        static const unsigned int CHANNELS = 2;
+
+        virtual ~AudioSink() { }
+
+        virtual bool Write(const int16_t *samples, unsigned int frames) = 0; // false: give up, mixer stops
+        virtual bool Blocking() const = 0; // paces the mixer itself
+};
+
+// Throws everything away, for running & benchmarking without audio
+class NullSink : public AudioSink
+{
+    public:
+        bool Write(const int16_t*, unsigned int) override { return true; }
+        bool Blocking() const override { return false; }
+};
+
+// Records to a .wav file, header gets its sizes when the sink is destroyed
+class WavSink : public AudioSink
+{
+    public:
+        explicit WavSink(const std::string &file);
+        ~WavSink() override;
+
+        bool IsOpen() const { return this->file != nullptr; }
+
+        bool Write(const int16_t *samples, unsigned int frames) override;
+        bool Blocking() const override { return false; }
+
+    private:
+        FILE *file;
+        uint32_t dataBytes;
+
+        void writeHeader();
+
+        WavSink(const WavSink&);
+        WavSink& operator=(const WavSink&);
+};
+
+#endif
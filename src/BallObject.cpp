@@ -1,12 +1,12 @@
 #include "BallObject.h"
 
 BallObject::BallObject()
-    : GameObject(), Radius(12.5f), Stuck(true)
+    : GameObject(), Radius(12.5f), Stuck(true), Sticky(false), PassThrough(false)
 {
 }
 
-BallObject::BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite)
-    : GameObject(pos, glm::vec2(radius * 2.0f, radius * 2.0f), sprite, glm::vec3(1.0f), velocity), Radius(radius), Stuck(true)
+BallObject::BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, TextureView sprite)
+    : GameObject(pos, glm::vec2(radius * 2.0f, radius * 2.0f), sprite, glm::vec3(1.0f), velocity), Radius(radius), Stuck(true), Sticky(false), PassThrough(false)
 {
 }
 
@@ -45,4 +45,6 @@ void BallObject::Reset(glm::vec2 position, glm::vec2 velocity)
     this->Position = position;
     this->Velocity = velocity;
     this->Stuck = true;
+    this->Sticky = false;
+    this->PassThrough = false;
 }
\ No newline at end of file
@@ -13,9 +13,10 @@ class BallObject : public GameObject
         // state
         float Radius;
         bool Stuck;
+        bool Sticky, PassThrough; // power-ups
 
         BallObject();
-        BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite);
+        BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, TextureView sprite);
 
         glm::vec2 Move(float dt, unsigned int window_width);
         void Reset(glm::vec2 position, glm::vec2 velocity);
@@ -0,0 +1,101 @@
+#include "ChunkRenderer.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+
+#include <cstddef>
+
+static_assert(sizeof(BrickInstance) == 8 * sizeof(float), "brick instances must be tightly packed");
+
+ChunkRenderer::ChunkRenderer(ShaderHandle shader, TextureView block, TextureView solid)
+    : shader(shader), block(block), solid(solid), levelGeneration(0)
+{
+    float vertices[] = {
+        // pos      // tex
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f
+    };
+
+    unsigned int VBO;
+    glGenBuffers(1, &VBO);
+    this->quadVBO.Reset(VBO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO.Get());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ChunkRenderer::Draw(const FrameSnapshot &frame)
+{
+    PROFILE_ZONE("ChunkRenderer::Draw");
+    // new level, GPU copies of old one are no use
+    if (frame.LevelGeneration != this->levelGeneration || frame.ChunkCount != this->chunks.size())
+    {
+        this->chunks.clear();
+        this->chunks.resize(frame.ChunkCount);
+        this->levelGeneration = frame.LevelGeneration;
+    }
+
+    ResourceManager::GetShader(this->shader).Use();
+    glActiveTexture(GL_TEXTURE0);
+    this->block.Bind();
+    glActiveTexture(GL_TEXTURE1);
+    this->solid.Bind();
+    glActiveTexture(GL_TEXTURE0);
+
+    for (const ChunkSnapshot &source : frame.Chunks)
+    {
+        GpuChunk &chunk = this->chunks[source.Index];
+        if (!chunk.Uploaded || chunk.Version != source.Version)
+            this->upload(chunk, frame, source);
+
+        if (chunk.InstanceCount == 0) // every brick destroyed
+            continue;
+
+        glBindVertexArray(chunk.VAO.Get());
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, chunk.InstanceCount);
+        RenderStats::DrawCalls++;
+    }
+    glBindVertexArray(0);
+}
+
+void ChunkRenderer::upload(GpuChunk &chunk, const FrameSnapshot &frame, const ChunkSnapshot &source)
+{
+    // first upload, set up vertex array: quad per vertex, brick per instance
+    if (chunk.VAO.Get() == 0)
+    {
+        unsigned int VAO, instances;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &instances);
+        chunk.VAO.Reset(VAO);
+        chunk.Instances.Reset(instances);
+
+        glBindVertexArray(chunk.VAO.Get());
+
+        glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO.Get());
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.Instances.Get());
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (void*)offsetof(BrickInstance, Position));
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (void*)offsetof(BrickInstance, Color));
+        glVertexAttribDivisor(2, 1);
+
+        glBindVertexArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.Instances.Get());
+    glBufferData(GL_ARRAY_BUFFER, source.Count * sizeof(BrickInstance), frame.Bricks.data() + source.First, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    chunk.InstanceCount = source.Count;
+    chunk.Version = source.Version;
+    chunk.Uploaded = true;
+}
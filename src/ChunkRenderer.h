@@ -0,0 +1,49 @@
+#ifndef CHUNK_RENDERER_H
+#define CHUNK_RENDERER_H
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "FrameSnapshot.h"
+#include "GLObject.h"
+#include "ResourceManager.h"
+
+/**
+ * Draws the level chunks of a FrameSnapshot, one instanced draw call per chunk.
+ *
+ * Every chunk gets its own instance buffer the first time it is seen. It is only
+ * re-uploaded when the chunk's version changed, so a still level costs no uploads.
+ * Lives on the render thread.
+ */
+class ChunkRenderer
+{
+    public:
+        ChunkRenderer(ShaderHandle shader, TextureView block, TextureView solid);
+
+        void Draw(const FrameSnapshot &frame);
+
+    private:
+        // GPU copy of a chunk, same index as GameLevel::Chunks
+        struct GpuChunk
+        {
+            GLVertexArray VAO;
+            GLBuffer Instances;
+            unsigned int InstanceCount;
+            unsigned int Version;
+            bool Uploaded;
+
+            GpuChunk() : InstanceCount(0), Version(0), Uploaded(false) { }
+        };
+
+        ShaderHandle shader; // handle, so renderer picks up reloaded shaders
+        TextureView block, solid;
+        GLBuffer quadVBO;
+        std::vector<GpuChunk> chunks;
+        unsigned int levelGeneration; // level chunks belong to
+
+        void upload(GpuChunk &chunk, const FrameSnapshot &frame, const ChunkSnapshot &source);
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <iostream>
+
+DoubleFrameArena RenderArena("render", RENDER_ARENA_SIZE);
+
+FrameArena::FrameArena(const char *name, size_t capacity)
+    : name(name), memory(capacity), used(0), highWater(0), overflows(0)
+{
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(this->memory.data());
+    uintptr_t start = (base + this->used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    size_t end = start - base + size;
+
+    this->highWater = std::max(this->highWater, end);
+    if (end > this->memory.size())
+    {
+        if (this->overflows++ == 0)
+            std::cout << "ERROR: " << this->name << " frame arena out of space, needs " << end << " of " << this->memory.size() << " bytes" << std::endl;
+        throw std::bad_alloc();
+    }
+    this->used = end;
+    return reinterpret_cast<void*>(start);
+}
+
+void FrameArena::Reset()
+{
+    this->used = 0;
+}
+
+FrameArena::Stats FrameArena::GetStats() const
+{
+    return Stats{ this->memory.size(), this->used, this->highWater, this->overflows };
+}
+
+FrameArena::Stats DoubleFrameArena::GetStats() const
+{
+    FrameArena::Stats current = this->arenas[this->current].GetStats();
+    FrameArena::Stats previous = this->arenas[this->current ^ 1].GetStats();
+    return FrameArena::Stats{ current.Capacity, current.Used, std::max(current.HighWater, previous.HighWater), current.Overflows + previous.Overflows };
+}
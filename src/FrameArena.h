@@ -0,0 +1,108 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Linear (bump) allocator over one fixed block for data that only lives for a
+ * frame. Allocating moves a pointer, freeing does nothing, Reset() frees
+ * everything at once. Not thread safe, one arena per thread.
+ *
+ * Out of space is an error (sized too small): Allocate logs it once and throws
+ * std::bad_alloc. HighWater includes the request that didn't fit, so it always
+ * tells how big the arena needs to be.
+ */
+class FrameArena
+{
+    public:
+        struct Stats
+        {
+            size_t Capacity;
+            size_t Used;      // since last Reset
+            size_t HighWater; // most Used ever got (or needed)
+            unsigned int Overflows;
+        };
+
+        FrameArena(const char *name, size_t capacity); // name shows up in errors
+
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+        template <typename T>
+        T* Allocate(size_t count) { return static_cast<T*>(this->Allocate(count * sizeof(T), alignof(T))); }
+        void Reset(); // everything allocated so far is gone
+
+        Stats GetStats() const;
+
+    private:
+        const char *name;
+        std::vector<unsigned char> memory;
+        size_t used;
+        size_t highWater;
+        unsigned int overflows;
+
+        FrameArena(const FrameArena&);
+        FrameArena& operator=(const FrameArena&);
+};
+
+/**
+ * Two arenas, for data that is read one frame after it was made. Swap() at the
+ * start of every frame: Current() is empty then, Previous() still holds what
+ * the last frame allocated.
+ */
+class DoubleFrameArena
+{
+    public:
+        DoubleFrameArena(const char *name, size_t capacity) : arenas{ FrameArena(name, capacity), FrameArena(name, capacity) }, current(0) { }
+
+        void Swap()
+        {
+            this->current ^= 1;
+            this->arenas[this->current].Reset();
+        }
+        FrameArena& Current() { return this->arenas[this->current]; }
+        FrameArena& Previous() { return this->arenas[this->current ^ 1]; }
+
+        FrameArena::Stats GetStats() const; // per arena: Current's Used, bigger HighWater of the two
+
+    private:
+        FrameArena arenas[2];
+        unsigned int current;
+};
+
+// Standard allocator on top of an arena, deallocate does nothing
+template <typename T>
+class ArenaAllocator
+{
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        explicit ArenaAllocator(FrameArena &arena) : Arena(&arena) { }
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) : Arena(other.Arena) { }
+
+        T* allocate(size_t count) { return this->Arena->template Allocate<T>(count); }
+        void deallocate(T*, size_t) { }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U> &other) const { return this->Arena == other.Arena; }
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U> &other) const { return this->Arena != other.Arena; }
+
+        FrameArena *Arena;
+};
+
+// e.g. ArenaVector<Contact> contacts{ ArenaAllocator<Contact>(RenderArena.Current()) };
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Render thread's arenas, swapped once per frame by the main loop (main.cpp)
+const size_t RENDER_ARENA_SIZE = 256 * 1024;
+extern DoubleFrameArena RenderArena;
+
+#endif
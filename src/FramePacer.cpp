@@ -0,0 +1,128 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+const int64_t LOG_INTERVAL_NS = 5000000000ll;   // log statistics every 5 seconds
+const int64_t MIN_SLEEP_MARGIN_NS = 200000;     // 0.2 ms
+const int64_t MAX_SLEEP_MARGIN_NS = 4000000;    // 4 ms
+
+FramePacer::FramePacer(SyncMode mode, double targetFps)
+    : mode(mode), periodNs(targetFps > 0.0 ? static_cast<int64_t>(1e9 / targetFps) : 0), sleepMarginNs(1000000),
+      sampleCount(0), sumMs(0.0), sumSquaresMs(0.0), maxMs(0.0)
+{
+    this->lastFrameNs = NowNs();
+    this->deadlineNs = this->lastFrameNs;
+    this->lastLogNs = this->lastFrameNs;
+}
+
+int64_t FramePacer::NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SyncMode FramePacer::Mode() const
+{
+    return this->mode;
+}
+
+int FramePacer::SwapInterval() const
+{
+    if (this->mode == SYNC_VSYNC)
+        return 1;
+    else if (this->mode == SYNC_ADAPTIVE)
+        return -1; // needs *_swap_control_tear, caller falls back to 1 without it
+    return 0;
+}
+
+void FramePacer::FrameEnd()
+{
+    if (this->periodNs > 0)
+    {
+        this->deadlineNs += this->periodNs;
+
+        int64_t now = NowNs();
+        if (now < this->deadlineNs)
+            this->waitUntil(this->deadlineNs);
+        else if (now - this->deadlineNs > this->periodNs) // missed by more than a frame, don't try to catch up
+            this->deadlineNs = now;
+    }
+
+    int64_t now = NowNs();
+    this->record((now - this->lastFrameNs) / 1e6);
+    this->lastFrameNs = now;
+
+    if (now - this->lastLogNs >= LOG_INTERVAL_NS)
+    {
+        this->logStatistics();
+        this->lastLogNs = now;
+    }
+}
+
+/**
+ * Sleeps until shortly before deadline, then spins the rest of the way.
+ */
+void FramePacer::waitUntil(int64_t deadlineNs)
+{
+    int64_t wakeNs = deadlineNs - this->sleepMarginNs;
+    int64_t now = NowNs();
+    if (wakeNs > now)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(wakeNs - now));
+
+        // keep margin at about twice how late sleeps wake up
+        int64_t lateNs = NowNs() - wakeNs;
+        this->sleepMarginNs += (2 * lateNs - this->sleepMarginNs) / 8;
+        this->sleepMarginNs = std::max(MIN_SLEEP_MARGIN_NS, std::min(this->sleepMarginNs, MAX_SLEEP_MARGIN_NS));
+    }
+
+    while (NowNs() < deadlineNs)
+        std::this_thread::yield();
+}
+
+void FramePacer::record(double frameMs)
+{
+    this->samples[this->sampleCount % SAMPLES] = static_cast<float>(frameMs);
+    this->sampleCount++;
+    this->sumMs += frameMs;
+    this->sumSquaresMs += frameMs * frameMs;
+    this->maxMs = std::max(this->maxMs, frameMs);
+}
+
+double FramePacer::MeanMs() const
+{
+    return this->sampleCount > 0 ? this->sumMs / this->sampleCount : 0.0;
+}
+
+double FramePacer::JitterMs() const
+{
+    if (this->sampleCount == 0)
+        return 0.0;
+    double mean = this->MeanMs();
+    return std::sqrt(std::max(this->sumSquaresMs / this->sampleCount - mean * mean, 0.0));
+}
+
+void FramePacer::logStatistics()
+{
+    if (this->sampleCount == 0)
+        return;
+
+    // 99th percentile of the last SAMPLES frames
+    unsigned int count = std::min(this->sampleCount, SAMPLES);
+    float sorted[SAMPLES];
+    std::copy(this->samples, this->samples + count, sorted);
+    unsigned int p99 = count * 99 / 100;
+    std::nth_element(sorted, sorted + p99, sorted + count);
+
+    double mean = this->MeanMs();
+    std::cout << "FRAME: " << 1000.0 / mean << " fps, mean " << mean << " ms, jitter " << this->JitterMs()
+        << " ms, p99 " << sorted[p99] << " ms, max " << this->maxMs << " ms" << std::endl;
+
+    this->sampleCount = 0;
+    this->sumMs = 0.0;
+    this->sumSquaresMs = 0.0;
+    this->maxMs = 0.0;
+}
@@ -0,0 +1,61 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+
+enum SyncMode
+{
+    SYNC_VSYNC,     // swap waits for vertical blank
+    SYNC_ADAPTIVE,  // like vsync, but late frames tear instead of waiting a whole refresh
+    SYNC_UNCAPPED   // swap never waits
+};
+
+/**
+ * Frame pacing for the render loop.
+ *
+ * Time is kept in int64 nanoseconds of a monotonic clock, so it doesn't lose
+ * precision in long sessions. With a target frame rate set, FrameEnd() holds each
+ * frame until its deadline: it sleeps for most of the wait and only spins (yielding)
+ * for the last stretch, which is sized from how late past sleeps woke up. So frames
+ * are steady without keeping a core busy.
+ *
+ * Frame-time statistics (mean, jitter, 99th percentile, worst) are logged every few seconds.
+ */
+class FramePacer
+{
+    public:
+        static const unsigned int SAMPLES = 1024; // frames kept for percentiles
+
+        FramePacer(SyncMode mode, double targetFps); // targetFps 0 = no limiter
+
+        static int64_t NowNs(); // monotonic
+
+        SyncMode Mode() const;
+        int SwapInterval() const; // value for glfwSwapInterval
+
+        // call right after presenting a frame, waits for next frame's deadline
+        void FrameEnd();
+
+        // over frames since last log
+        double MeanMs() const;
+        double JitterMs() const; // standard deviation of frame time
+
+    private:
+        SyncMode mode;
+        int64_t periodNs;     // 0 = no limiter
+        int64_t deadlineNs;   // when current frame may end
+        int64_t lastFrameNs;  // previous FrameEnd
+        int64_t sleepMarginNs; // spin this long before deadline, adapts to scheduler
+
+        // statistics since last log
+        float samples[SAMPLES]; // frame times in ms, ring buffer
+        unsigned int sampleCount;
+        double sumMs, sumSquaresMs, maxMs;
+        int64_t lastLogNs;
+
+        void waitUntil(int64_t deadlineNs);
+        void record(double frameMs);
+        void logStatistics();
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef FRAME_SNAPSHOT_H
+#define FRAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Texture.h"
+#include "ParticleGenerator.h"
+
+struct SpriteSnapshot
+{
+    glm::vec2 Position, Size;
+    glm::vec3 Color;
+    float Rotation;
+    TextureView Sprite;
+};
+
+// besides the main one, from the multiball power-up
+const unsigned int MAX_EXTRA_BALLS = 2;
+
+// One brick as the brick shader's instance attributes expect it (power-ups too)
+struct BrickInstance
+{
+    glm::vec2 Position, Size;
+    glm::vec3 Color;
+    float Solid; // 1 or 0
+};
+
+// A visible chunk, its bricks are Bricks[First, First + Count) of the snapshot
+struct ChunkSnapshot
+{
+    unsigned int Index;   // in GameLevel::Chunks
+    unsigned int Version; // LevelChunk::Version when copied
+    unsigned int First, Count;
+};
+
+// Screen effects for PostProcessor, all off means no post-processing at all
+struct PostEffects
+{
+    bool Shake;   // ball hit a solid brick
+    bool Chaos;   // power-ups
+    bool Confuse;
+    float Flash;  // 0 - 1, fades out after catching a power-up
+
+    PostEffects() : Shake(false), Chaos(false), Confuse(false), Flash(0.0f) { }
+    bool Any() const { return this->Shake || this->Chaos || this->Confuse || this->Flash > 0.0f; }
+};
+
+/**
+ * Everything the render thread needs to draw one frame, published by the sim
+ * thread every tick. Only what is in view is copied, so its size doesn't grow
+ * with the level. Vectors are reused, so publishing doesn't allocate once warm.
+ */
+struct FrameSnapshot
+{
+    uint64_t Tick;
+    bool Active; // game state is GAME_ACTIVE
+    glm::vec2 Camera;
+    int64_t InputNs; // time of newest input event applied, for latency measurement
+    float SimMs;     // how long the tick that produced this took, for the overlay
+    uint64_t SimAllocations; // heap allocations of previous tick (see AllocTracker.h)
+
+    unsigned int LevelGeneration; // changes whenever chunk indices mean something else
+    unsigned int ChunkCount;
+    std::vector<ChunkSnapshot> Chunks;
+    std::vector<BrickInstance> Bricks; // live bricks of visible chunks
+    unsigned int BricksLeft; // whole level, not just in view
+
+    SpriteSnapshot Player, Ball;
+    SpriteSnapshot ExtraBalls[MAX_EXTRA_BALLS];
+    unsigned int ExtraBallCount;
+    std::vector<Particle> Particles; // live ones only
+    std::vector<BrickInstance> PowerUps; // falling ones
+    PostEffects Post;
+
+    FrameSnapshot() : Tick(0), Active(false), Camera(0.0f), InputNs(0), SimMs(0.0f), SimAllocations(0), LevelGeneration(0), ChunkCount(0), BricksLeft(0), Player(), Ball(), ExtraBalls(), ExtraBallCount(0), Post() { }
+};
+
+#endif
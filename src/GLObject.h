@@ -0,0 +1,66 @@
+#ifndef GL_OBJECT_H
+#define GL_OBJECT_H
+
+#include <utility>
+
+#include <glad/glad.h>
+
+inline void deleteGLTexture(unsigned int id)     { glDeleteTextures(1, &id); }
+inline void deleteGLProgram(unsigned int id)     { glDeleteProgram(id); }
+inline void deleteGLVertexArray(unsigned int id) { glDeleteVertexArrays(1, &id); }
+inline void deleteGLBuffer(unsigned int id)      { glDeleteBuffers(1, &id); }
+inline void deleteGLFramebuffer(unsigned int id) { glDeleteFramebuffers(1, &id); }
+inline void deleteGLQuery(unsigned int id)       { glDeleteQueries(1, &id); }
+
+/**
+ * Owns one OpenGL object name and deletes it when destroyed. Move-only, so a name
+ * has exactly one owner. Name 0 means "nothing owned".
+ * Must be destroyed on the thread that owns the OpenGL context.
+ */
+template <void (*Delete)(unsigned int)>
+class GLObject
+{
+    public:
+        GLObject() : id(0) { }
+        explicit GLObject(unsigned int id) : id(id) { }
+        ~GLObject() { this->Reset(); }
+
+        GLObject(GLObject &&other) noexcept : id(other.Release()) { }
+        GLObject& operator=(GLObject &&other) noexcept
+        {
+            if (this != &other)
+                this->Reset(other.Release());
+            return *this;
+        }
+
+        GLObject(const GLObject&) = delete;
+        GLObject& operator=(const GLObject&) = delete;
+
+        unsigned int Get() const { return this->id; }
+
+        // deletes owned name (if any) and takes ownership of id
+        void Reset(unsigned int id = 0)
+        {
+            if (this->id != 0)
+                Delete(this->id);
+            this->id = id;
+        }
+
+        // gives up ownership without deleting
+        unsigned int Release()
+        {
+            return std::exchange(this->id, 0u);
+        }
+
+    private:
+        unsigned int id;
+};
+
+typedef GLObject<deleteGLTexture>     GLTexture;
+typedef GLObject<deleteGLProgram>     GLProgram;
+typedef GLObject<deleteGLVertexArray> GLVertexArray;
+typedef GLObject<deleteGLBuffer>      GLBuffer;
+typedef GLObject<deleteGLFramebuffer> GLFramebuffer;
+typedef GLObject<deleteGLQuery>       GLQuery;
+
+#endif
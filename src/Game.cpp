@@ -1,11 +1,33 @@
 #include "Game.h"
 #include "ResourceManager.h"
 #include "SpriteRenderer.h"
+#include "ChunkRenderer.h"
+#include "PowerUpRenderer.h"
+#include "PostProcessor.h"
+#include "GpuTimer.h"
+#include "ResolutionScaler.h"
+#include "StateSnapshot.h"
+#include "AudioMixer.h"
+#include "OverlayRenderer.h"
+#include "RenderStats.h"
 #include "BallObject.h"
 #include "ParticleGenerator.h"
+#include "ParticleGovernor.h"
+#include "AssetWatcher.h"
+#include "FrameSnapshot.h"
+#include "TripleBuffer.h"
+#include "FramePacer.h"
+#include "AllocTracker.h"
+#include "Profiler.h"
+#include <cmath>
+#include <cstring>
 #include <tuple>
-
-typedef std::tuple<bool, Direction, glm::vec2> Collision;   
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 
 /**
  * Returns direction that vector points.
@@ -91,70 +113,434 @@ const float BALL_RADIUS = 12.5f;
 
 BallObject *Ball;
 
+// multiball power-up, Ball stays the main one
+BallObject ExtraBalls[MAX_EXTRA_BALLS];
+unsigned int ExtraBallCount = 0;
+
+// falling power-ups & running effects, sim thread only
+PowerUpPool PowerUps;
+PowerUpEffects Effects;
+uint32_t PowerUpRandom = 1; // LCG state, rand() takes a lock & this runs per destroyed brick
+
+const float SPEED_POWERUP_FACTOR = 1.3f;
+const float PADDLE_POWERUP_FACTOR = 1.5f;
+
+// screen effects, sim thread counts them down
+const float SHAKE_DURATION = 0.05f; // after ball hits a solid brick
+const float FLASH_DURATION = 0.15f; // after catching a power-up
+float ShakeTime = 0.0f, FlashTime = 0.0f;
+
+// sound effects, sim thread posts them, mixer thread plays them
+AudioMixer Audio; // Play is harmless before Init/Start (e.g. benchmarks), queue fills & drops
+AudioSink *AudioOutput = nullptr;
+ClipHandle BrickSound, SolidSound, PaddleSound, PowerUpSound;
+
 Game::Game(unsigned  int width, unsigned int height)
-    : State(GAME_ACTIVE), Keys(), Width(width), Height(height) // initialize state
+    : State(GAME_ACTIVE), Keys(), Width(width), Height(height), ShowOverlay(false), RenderScale(0.0f), GpuBudgetMs(1000.0f / 60.0f), inputTimeNs(0), latestInputNs(0), simMs(0.0f) // initialize state
 {
 }
 
 Game::~Game()
 {
+    this->Stop();
+    delete AudioOutput; // mixer stopped, finishes the .wav
 }
 
+// looked up by handle every frame, names only at load time
+ShaderHandle SpriteShader, ParticleShader, BrickShader, OverlayShader, PostShader;
+
 SpriteRenderer *Renderer;
+ChunkRenderer *LevelRenderer;
+PowerUpRenderer *PowerUpsRenderer;
+OverlayRenderer *Overlay;
+PostProcessor *PostProcess;
+
+// dynamic resolution, render thread only
+GpuTimer *SceneTimer;
+ResolutionScaler *Scaler;
+float SceneGpuMs = 0.0f; // newest measurement, a few frames old
+
+TextureHandle BackgroundTexture;
+
+glm::vec2 Camera(0.0f); // top left of view, in world space
+std::vector<unsigned int> NearbyChunks; // reused by DoCollisions, ball never covers more than 4 chunks
 
 ParticleGenerator *Particles;
 
+const unsigned int PARTICLE_AMOUNT = 500;
+const float PARTICLE_BUDGET_MS = 2.0f; // time per frame particles may spend updating & drawing
+
+ParticleGovernor *Governor;
+
+AssetWatcher *Watcher = nullptr;
+
+// Sim thread publishes a snapshot every tick, render thread draws the latest one
+const float SIM_STEP = 1.0f / 120.0f; // seconds per tick
+
+TripleBuffer<FrameSnapshot> Snapshots;
+std::thread SimThread;
+std::atomic<bool> Simulating(false);
+uint64_t SimTicks = 0; // sim thread only
+std::atomic<float> ParticleDrawMs(0.0f); // measured on render thread, budgeted on sim thread
+
+// rewind history, a state per tick (see StateSnapshot.h), sim thread only
+const float REWIND_SECONDS = 10.0f;
+const unsigned int REWIND_SPEED = 2; // ticks back per tick while R is held
+const char *QUICKSAVE_FILE = "quicksave.sav";
+SnapshotRing History(8 * 1024 * 1024, static_cast<unsigned int>(std::lround(REWIND_SECONDS / SIM_STEP)) + 1, 120); // keyframe every second
+BrickBits LevelBits;
+std::vector<unsigned char> StateBuffer; // reused every tick
+
+// input older than this is dropped, not replayed
+const int64_t MAX_INPUT_LAG_NS = 100000000; // 100 ms
+
+// performance overlay, render thread only
+int64_t LastRenderNs = 0;
+float OverlayMs = 0.0f;
+
+// input-to-present latency, render thread only
+const FrameSnapshot *PresentedFrame = nullptr;
+int64_t PresentedInputNs = 0;
+double InputLatencySumMs = 0.0, InputLatencyMaxMs = 0.0;
+unsigned int InputLatencyCount = 0;
+
+// changed level files, handed from render thread to sim thread (try_lock on both sides)
+std::mutex LevelReloadsMutex;
+std::vector<std::string> LevelReloads;
+std::vector<std::string> PendingLevelReloads; // render thread only, not handed over yet
+
 void Game::Init()
 {
     // Load & configure resources
 
-    // Shader program
-    ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.fs", nullptr, "sprite");
-    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
-    ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-    ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
+    // Start decoding textures on worker threads
+    ResourceManager::LoadTextureAsync("textures/background.jpg", false, "background");
+    ResourceManager::LoadTextureAsync("textures/awesomeface.png", true, "face");
+    ResourceManager::LoadTextureAsync("textures/block.png", false, "block");
+    ResourceManager::LoadTextureAsync("textures/block_solid.png", false, "block_solid");
+    ResourceManager::LoadTextureAsync("textures/paddle.png", true, "paddle");
+    ResourceManager::LoadTextureAsync("textures/particle.png", true, "particle");
+
+    // Shader programs
+    SpriteShader = ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.fs", nullptr, "sprite");
+    ParticleShader = ResourceManager::LoadShader("shaders/particle.vs", "shaders/particle.fs", nullptr, "particle");
+    BrickShader = ResourceManager::LoadShader("shaders/brick.vs", "shaders/brick.fs", nullptr, "brick");
+    OverlayShader = ResourceManager::LoadShader("shaders/overlay.vs", "shaders/overlay.fs", nullptr, "overlay");
+    PostShader = ResourceManager::LoadShader("shaders/post.vs", "shaders/post.fs", nullptr, "post");
+    this->configureShaders();
 
     // Renderer
-    Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
+    Renderer = new SpriteRenderer(SpriteShader);
+    Overlay = new OverlayRenderer(OverlayShader);
+    PostProcess = new PostProcessor(PostShader, this->Width, this->Height);
+    SceneTimer = new GpuTimer();
+    Scaler = new ResolutionScaler(this->GpuBudgetMs);
+    Scaler->Pin(this->RenderScale);
+    PostProcess->SetScale(Scaler->Scale());
+
+    // Textures (all decoded while shaders compile, uploaded below)
+    ResourceManager::WaitForTextures();
+    BackgroundTexture = ResourceManager::FindTexture("background");
+    LevelRenderer = new ChunkRenderer(BrickShader, ResourceManager::GetTexture("block"), ResourceManager::GetTexture("block_solid"));
+    PowerUpsRenderer = new PowerUpRenderer(BrickShader, ResourceManager::GetTexture("block"), ResourceManager::GetTexture("block_solid"));
+
+    this->InitWorld();
+
+    // Particle generator
+    Particles = new ParticleGenerator(ParticleShader, ResourceManager::GetTexture("particle"), PARTICLE_AMOUNT);
+    Governor = new ParticleGovernor(PARTICLE_BUDGET_MS, PARTICLE_AMOUNT);
 
-    // Textures
-    ResourceManager::LoadTexture("textures/background.jpg", false, "background");
-    ResourceManager::LoadTexture("textures/awesomeface.png", true, "face");
-    ResourceManager::LoadTexture("textures/block.png", false, "block");
-    ResourceManager::LoadTexture("textures/block_solid.png", false, "block_solid");
-    ResourceManager::LoadTexture("textures/paddle.png", true, "paddle");
+    // Audio, clips are made up front & stay in memory
+    BrickSound = Audio.AddClip("brick", AudioMixer::Tone(880.0f, 0.08f, 0.4f));
+    SolidSound = Audio.AddClip("solid", AudioMixer::Tone(220.0f, 0.12f, 0.4f));
+    PaddleSound = Audio.AddClip("paddle", AudioMixer::Tone(440.0f, 0.06f, 0.4f));
+    PowerUpSound = Audio.AddClip("powerup", AudioMixer::Tone(1320.0f, 0.2f, 0.3f));
+    if (!this->AudioFile.empty())
+    {
+        WavSink *wav = new WavSink(this->AudioFile);
+        if (wav->IsOpen())
+            AudioOutput = wav;
+        else
+            delete wav; // error already printed, fall back to silence
+    }
+    if (AudioOutput == nullptr)
+        AudioOutput = new NullSink();
+
+    // Hot reload (not when running from an asset pack)
+    if (!ResourceManager::Pack.IsOpen())
+        Watcher = new AssetWatcher({ "shaders", "textures", "levels" });
+}
 
+void Game::InitWorld()
+{
     // Levels
     GameLevel one; one.Load("levels/one.lvl", this->Width, this->Height / 2);
     GameLevel two; two.Load("levels/two.lvl", this->Width, this->Height / 2);
     GameLevel three; three.Load("levels/three.lvl", this->Width, this->Height / 2);
     GameLevel four; four.Load("levels/four.lvl", this->Width, this->Height / 2);
-    this->Levels.push_back(one);
-    this->Levels.push_back(two);
-    this->Levels.push_back(three);
-    this->Levels.push_back(four);
+    this->Levels.push_back(std::move(one));
+    this->Levels.push_back(std::move(two));
+    this->Levels.push_back(std::move(three));
+    this->Levels.push_back(std::move(four));
     this->Level = 0;
 
     // Player
-    glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+    glm::vec2 world = this->WorldSize();
+    glm::vec2 playerPos = glm::vec2(world.x / 2.0f - PLAYER_SIZE.x / 2.0f, world.y - PLAYER_SIZE.y);
     Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
 
+    NearbyChunks.reserve(4);
+
     // Ball
     glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
     Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+}
 
-    // Particle generator
-    ResourceManager::LoadTexture("textures/particle.png", true, "particle");
-    ResourceManager::LoadShader("shaders/particle.vs", "shaders/particle.fs", nullptr, "particle");
-    ResourceManager::GetShader("particle").Use().SetMatrix4("projection", projection);
-    Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
+void Game::configureShaders()
+{
+    ResourceManager::GetShader(SpriteShader).Use().SetInteger("image", 0);
+    ResourceManager::GetShader(BrickShader).Use().SetInteger("block", 0);
+    ResourceManager::GetShader(BrickShader).SetInteger("solid", 1);
+    // overlay is drawn in screen space
+    glm::mat4 screen = glm::ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
+    ResourceManager::GetShader(OverlayShader).Use().SetInteger("atlas", 0);
+    ResourceManager::GetShader(OverlayShader).SetMatrix4("projection", screen);
+    ResourceManager::GetShader(PostShader).Use().SetInteger("scene", 0);
+    this->setView(Camera);
+}
+
+/**
+ * Projection for given camera position, everything is drawn in world space.
+ */
+void Game::setView(glm::vec2 camera)
+{
+    glm::mat4 projection = glm::ortho(camera.x, camera.x + this->Width, camera.y + this->Height, camera.y, -1.0f, 1.0f);
+    ResourceManager::GetShader(SpriteShader).Use().SetMatrix4("projection", projection);
+    ResourceManager::GetShader(ParticleShader).Use().SetMatrix4("projection", projection);
+    ResourceManager::GetShader(BrickShader).Use().SetMatrix4("projection", projection);
+}
+
+/**
+ * Current level plus room for the paddle below it, at least one screen big.
+ */
+glm::vec2 Game::WorldSize() const
+{
+    const GameLevel &level = this->Levels[this->Level];
+    return glm::vec2(std::max(static_cast<float>(this->Width), level.Size.x),
+                     std::max(static_cast<float>(this->Height), level.Size.y + this->Height / 2.0f));
+}
+
+/**
+ * Camera follows ball, but never shows anything outside the world.
+ */
+void Game::updateCamera()
+{
+    glm::vec2 screen(this->Width, this->Height);
+    glm::vec2 target = Ball->Position + Ball->Radius - screen / 2.0f;
+    Camera = glm::clamp(target, glm::vec2(0.0f), this->WorldSize() - screen);
+}
+
+/**
+ * Only the changed asset is reloaded. Textures are decoded on a worker thread and
+ * uploaded here once ready, so a reload never stalls a frame on decoding.
+ */
+void Game::ReloadAssets()
+{
+    if (Watcher == nullptr)
+        return;
+
+    for (const std::string &file : Watcher->TakeChanged())
+    {
+        SteadyFrame::MarkUnsteady();
+        if (ResourceManager::ReloadShaderFile(file))
+        {
+            this->configureShaders(); // new program, uniforms start out empty
+            std::cout << "RELOAD: " << file << std::endl;
+        }
+        else if (ResourceManager::ReloadTextureFile(file))
+        {
+            std::cout << "RELOAD: " << file << std::endl;
+        }
+        else
+        {
+            PendingLevelReloads.push_back(file); // levels belong to sim thread
+        }
+    }
+
+    if (!PendingLevelReloads.empty() && LevelReloadsMutex.try_lock())
+    {
+        LevelReloads.insert(LevelReloads.end(), PendingLevelReloads.begin(), PendingLevelReloads.end());
+        LevelReloadsMutex.unlock();
+        PendingLevelReloads.clear();
+    }
+
+    ResourceManager::UploadPendingTextures();
 }
 
+/**
+ * Sim thread side of ReloadAssets, checked at the start of every tick.
+ */
+void Game::reloadLevels()
+{
+    static std::vector<std::string> files;
+    if (!LevelReloadsMutex.try_lock())
+        return; // render thread is handing some over, next tick
+    files.swap(LevelReloads);
+    LevelReloadsMutex.unlock();
+
+    for (const std::string &file : files)
+    {
+        for (GameLevel &level : this->Levels)
+        {
+            if (level.File == file)
+            {
+                SteadyFrame::MarkUnsteady();
+                level.Load(file.c_str(), this->Width, this->Height / 2, false);
+                std::cout << "RELOAD: " << file << std::endl;
+            }
+        }
+    }
+    files.clear();
+}
+
+/**
+ * Starts sim thread, call after Init. From now on only Render and ReloadAssets
+ * may be called from the render thread.
+ */
+void Game::Start()
+{
+    this->updateCamera();
+    this->publishSnapshot(); // something to draw before first tick
+
+    Audio.Start(AudioOutput);
+    Simulating.store(true, std::memory_order_release);
+    SimThread = std::thread(&Game::simulate, this);
+}
+
+void Game::Stop()
+{
+    Simulating.store(false, std::memory_order_release);
+    if (SimThread.joinable())
+        SimThread.join();
+    Audio.Stop();
+}
+
+/**
+ * Fixed rate ticks, independent of how fast frames are presented.
+ */
+void Game::simulate()
+{
+    typedef std::chrono::steady_clock clock;
+    const clock::duration step = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(SIM_STEP));
+
+    PROFILE_THREAD("sim");
+    clock::time_point next = clock::now();
+    while (Simulating.load(std::memory_order_acquire))
+    {
+        {
+            SteadyFrame frame("sim"); // ticks don't allocate once warmed up (see AllocTracker.h)
+            clock::time_point tickStart = clock::now();
+            this->reloadLevels();
+            this->ProcessInput(SIM_STEP);
+            this->Update(SIM_STEP);
+            this->simMs = std::chrono::duration<float, std::milli>(clock::now() - tickStart).count();
+            this->publishSnapshot();
+        }
+
+        next += step;
+        clock::time_point now = clock::now();
+        if (now - next > 4 * step) // far behind (e.g. loading a huge level), don't try to catch up
+            next = now;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+static SpriteSnapshot spriteSnapshot(const GameObject &object)
+{
+    return SpriteSnapshot{ object.Position, object.Size, object.Color, object.Rotation, object.Sprite };
+}
+
+/**
+ * Copies what the render thread needs into the triple buffer's back slot and publishes it.
+ */
+void Game::publishSnapshot()
+{
+    PROFILE_ZONE("Game::publishSnapshot");
+    FrameSnapshot &frame = Snapshots.Back();
+    frame.Tick = SimTicks++;
+    frame.Active = this->State == GAME_ACTIVE;
+    frame.Camera = Camera;
+    frame.InputNs = this->latestInputNs;
+    frame.SimMs = this->simMs;
+    frame.SimAllocations = SteadyFrame::LastFrameAllocations();
+
+    glm::vec2 screen(this->Width, this->Height);
+    this->Levels[this->Level].Snapshot(Camera, Camera + screen, frame);
+    frame.BricksLeft = this->Levels[this->Level].BricksLeft;
+
+    frame.Player = spriteSnapshot(*Player);
+    frame.Ball = spriteSnapshot(*Ball);
+    frame.ExtraBallCount = ExtraBallCount;
+    for (unsigned int i = 0; i < ExtraBallCount; i++)
+        frame.ExtraBalls[i] = spriteSnapshot(ExtraBalls[i]);
+    Particles->Snapshot(frame.Particles);
+    PowerUps.Snapshot(frame.PowerUps);
+    frame.Post.Shake = ShakeTime > 0.0f;
+    frame.Post.Chaos = Effects.Active(POWERUP_CHAOS);
+    frame.Post.Confuse = Effects.Active(POWERUP_CONFUSE);
+    frame.Post.Flash = FlashTime / FLASH_DURATION;
+
+    Snapshots.Publish();
+}
+
+/**
+ * Applies queued input events at the time they happened: the paddle moves with
+ * the keys held before an event up to the event's time, then with the new keys.
+ * Covers [inputTimeNs, inputTimeNs + dt], later events wait for the next tick.
+ */
 void Game::ProcessInput(float dt)
+{
+    int64_t endNs = this->inputTimeNs + static_cast<int64_t>(dt * 1e9);
+    int64_t now = FramePacer::NowNs();
+    if (now - endNs > MAX_INPUT_LAG_NS) // first tick or sim stalled, don't replay the past
+    {
+        endNs = now;
+        this->inputTimeNs = now - static_cast<int64_t>(dt * 1e9);
+    }
+
+    const InputEvent *event;
+    while ((event = this->Input.Front()) != nullptr && event->TimeNs <= endNs)
+    {
+        if (event->TimeNs > this->inputTimeNs)
+        {
+            this->movePlayer((event->TimeNs - this->inputTimeNs) / 1e9f);
+            this->inputTimeNs = event->TimeNs;
+        }
+
+        this->Keys[event->Key] = event->Pressed;
+        if (event->Pressed && event->Key == GLFW_KEY_SPACE && this->State == GAME_ACTIVE) // taps shorter than a tick count too
+            Ball->Stuck = false;
+        if (event->Pressed && event->Key == GLFW_KEY_F5)
+            this->SaveState(QUICKSAVE_FILE);
+        if (event->Pressed && event->Key == GLFW_KEY_F9)
+            this->LoadState(QUICKSAVE_FILE);
+        this->latestInputNs = event->TimeNs;
+        this->Input.Pop();
+    }
+
+    this->movePlayer((endNs - this->inputTimeNs) / 1e9f);
+    this->inputTimeNs = endNs;
+}
+
+/**
+ * Moves paddle (and stuck ball) for dt seconds with the keys currently held.
+ */
+void Game::movePlayer(float dt)
 {
     if (this->State == GAME_ACTIVE)
     {
         float distanceMoved = PLAYER_VELOCITY * dt;
+        float worldWidth = this->WorldSize().x;
 
         if (this->Keys[GLFW_KEY_A]) // left
         {
@@ -177,14 +563,14 @@ void Game::ProcessInput(float dt)
         }
         if (this->Keys[GLFW_KEY_D]) // right
         {
-            if (Player->Position.x <= this->Width - Player->Size.x)
+            if (Player->Position.x <= worldWidth - Player->Size.x)
             {
                 Player->Position.x += distanceMoved;
 
                 // right boundary
-                if (Player->Position.x > this->Width - Player->Size.x)
+                if (Player->Position.x > worldWidth - Player->Size.x)
                 {
-                    Player->Position.x = this->Width - Player->Size.x;
+                    Player->Position.x = worldWidth - Player->Size.x;
                 }
 
                 if (Ball->Stuck)
@@ -202,88 +588,258 @@ void Game::ProcessInput(float dt)
 
 void Game::Update(float dt)
 {
-    Ball->Move(dt, this->Width);
+    PROFILE_ZONE("Game::Update");
+    if (this->Keys[GLFW_KEY_R]) // time runs backwards while held
+    {
+        this->Rewind(REWIND_SPEED * SIM_STEP);
+        this->updateCamera();
+        return;
+    }
+
+    glm::vec2 world = this->WorldSize();
+    Ball->Move(dt, world.x);
+    for (unsigned int i = 0; i < ExtraBallCount; i++)
+        ExtraBalls[i].Move(dt, world.x);
     this->DoCollisions();
+    this->updatePowerUps(dt);
 
+    Governor->BeginSample();
     Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f));
+    Governor->EndSample();
+    Governor->AddSample(ParticleDrawMs.load(std::memory_order_relaxed)); // latest frame's draw
 
-    if (Ball->Position.y >= this->Height) // player lost ball
+    // scale particle load for next tick
+    Governor->EndFrame();
+    Particles->SetSpawnScale(Governor->SpawnScale());
+    Particles->SetMaxLive(Governor->MaxLive());
+
+    for (unsigned int i = 0; i < ExtraBallCount; )
     {
-        this->ResetLevel();
-        this->ResetPlayer();
+        if (ExtraBalls[i].Position.y >= world.y) // lost, last one takes its place
+            ExtraBalls[i] = ExtraBalls[--ExtraBallCount];
+        else
+            i++;
+    }
+    if (Ball->Position.y >= world.y) // player lost ball
+    {
+        if (ExtraBallCount > 0) // an extra one carries on as main ball
+        {
+            bool sticky = Ball->Sticky;
+            *Ball = ExtraBalls[--ExtraBallCount];
+            Ball->Sticky = sticky;
+        }
+        else
+        {
+            this->ResetLevel();
+            this->ResetPlayer();
+        }
+    }
+
+    this->updateCamera();
+
+    {
+        PROFILE_ZONE("Game::captureState");
+        this->captureState(StateBuffer);
+        History.Push(SimTicks, StateBuffer.data(), StateBuffer.size());
     }
 }
 
+/**
+ * Render thread. Draws latest snapshot, never touches live game state.
+ */
 void Game::Render()
 {
-    if (this->State == GAME_ACTIVE)
+    PROFILE_ZONE("Game::Render");
+    SteadyFrame steady("render"); // GL driver allocations count too
+    const FrameSnapshot &frame = Snapshots.Front();
+    PresentedFrame = &frame;
+    RenderStats::DrawCalls = 0;
+
+    int64_t now = FramePacer::NowNs();
+    float frameMs = LastRenderNs != 0 ? (now - LastRenderNs) / 1e6f : 0.0f;
+    Overlay->AddFrameTime(frameMs);
+    LastRenderNs = now;
+    // scene resolution follows GPU time, measured a few frames back
+    float gpuMs;
+    if (SceneTimer->Read(gpuMs))
     {
-        // draw background
-        Renderer->DrawSprite(ResourceManager::GetTexture("background"), glm::vec2(0.0f,0.0f), glm::vec2(this->Width,this->Height), 0.0f);
+        SceneGpuMs = gpuMs;
+        PostProcess->SetScale(Scaler->Update(gpuMs));
+    }
 
-        // draw level
-        this->Levels[this->Level].Draw(*Renderer);
+    if (frame.Active)
+    {
+        glm::vec2 screen(this->Width, this->Height);
+        this->setView(frame.Camera);
+        SceneTimer->Begin();
+
+        // into offscreen buffer if any screen effect is on or the scene is scaled
+        bool postProcessing = PostProcess->Begin(frame.Post);
+
+        // draw background (stays put on screen)
+        Renderer->DrawSprite(ResourceManager::GetTexture(BackgroundTexture), frame.Camera, screen, 0.0f);
+
+        // draw level, only chunks in view
+        LevelRenderer->Draw(frame);
+
+        // draw falling power-ups, one draw call
+        PowerUpsRenderer->Draw(frame.PowerUps);
 
         // draw player (paddle)
-        Player->Draw(*Renderer);
+        Renderer->DrawSprite(frame.Player.Sprite, frame.Player.Position, frame.Player.Size, frame.Player.Rotation, frame.Player.Color);
 
-        // draw particles
-        Particles->Draw();
+        // draw particles, time goes to Governor on sim thread
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Particles->Draw(frame.Particles);
+        std::chrono::duration<float, std::milli> drawMs = std::chrono::steady_clock::now() - start;
+        ParticleDrawMs.store(drawMs.count(), std::memory_order_relaxed);
 
         // draw ball
-        Ball->Draw(*Renderer);
+        Renderer->DrawSprite(frame.Ball.Sprite, frame.Ball.Position, frame.Ball.Size, frame.Ball.Rotation, frame.Ball.Color);
+        for (unsigned int i = 0; i < frame.ExtraBallCount; i++)
+        {
+            const SpriteSnapshot &ball = frame.ExtraBalls[i];
+            Renderer->DrawSprite(ball.Sprite, ball.Position, ball.Size, ball.Rotation, ball.Color);
+        }
+
+        // all effects in one pass
+        if (postProcessing)
+            PostProcess->End((now % 3600000000000LL) / 1e9f); // wraps hourly, keeps float precision
+        SceneTimer->End();
+    }
+
+    // performance overlay on top, one draw call
+    if (this->ShowOverlay)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        OverlayStats stats;
+        stats.FrameMs = frameMs;
+        stats.SimMs = frame.SimMs;
+        stats.DrawCalls = RenderStats::DrawCalls;
+        stats.Particles = frame.Particles.size();
+        stats.BricksLeft = frame.BricksLeft;
+        stats.OverlayMs = OverlayMs;
+        stats.AllocationsTracked = AllocTracker::Enabled;
+        stats.RenderAllocations = SteadyFrame::LastFrameAllocations();
+        stats.SimAllocations = frame.SimAllocations;
+        stats.GpuMs = SceneGpuMs;
+        stats.RenderScale = PostProcess->Scale();
+        stats.ScalePinned = Scaler->Pinned();
+        Overlay->Update(stats);
+        Overlay->Draw();
+        OverlayMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+/**
+ * View keeps its size in world units, it is scaled to fit the new framebuffer
+ * (letterboxed), so a bigger or HiDPI window shows the same, just sharper.
+ */
+void Game::Resize(unsigned int width, unsigned int height)
+{
+    PostProcess->Resize(width, height);
+}
+
+/**
+ * Render thread, right after the frame drawn by Render was presented. Measures how
+ * long the newest input in it took to reach the screen, logged every 32 inputs.
+ */
+void Game::FramePresented()
+{
+    if (PresentedFrame == nullptr || PresentedFrame->InputNs == PresentedInputNs)
+        return;
+    PresentedInputNs = PresentedFrame->InputNs;
+
+    double latencyMs = (FramePacer::NowNs() - PresentedInputNs) / 1e6;
+    InputLatencySumMs += latencyMs;
+    InputLatencyMaxMs = std::max(InputLatencyMaxMs, latencyMs);
+    if (++InputLatencyCount == 32)
+    {
+        std::cout << "INPUT: input to present latency mean " << InputLatencySumMs / InputLatencyCount
+            << " ms, max " << InputLatencyMaxMs << " ms" << std::endl;
+        InputLatencySumMs = InputLatencyMaxMs = 0.0;
+        InputLatencyCount = 0;
     }
 }
 
 void Game::DoCollisions()
 {
-    // Ball-brick collision
-    for (GameObject &box : this->Levels[this->Level].Bricks)
+    PROFILE_ZONE("Game::DoCollisions");
+    this->collideBall(*Ball);
+    for (unsigned int i = 0; i < ExtraBallCount; i++)
+        this->collideBall(ExtraBalls[i]);
+}
+
+/**
+ * Ball-brick collision, only bricks in chunks the ball touches, then ball-paddle.
+ */
+void Game::collideBall(BallObject &ball)
+{
+    GameLevel &level = this->Levels[this->Level];
+    float pan = (ball.Position.x + ball.Radius) / this->WorldSize().x * 2.0f - 1.0f; // sounds follow the ball
+    level.FindChunks(ball.Position, ball.Position + ball.Size, NearbyChunks);
+    for (unsigned int c : NearbyChunks)
     {
-        if (!box.Destroyed)
+        LevelChunk &chunk = level.Chunks[c];
+        for (unsigned int i = chunk.First; i < chunk.First + chunk.Count; i++)
         {
-            Collision collision = CheckCollision(*Ball, box);
-            if (std::get<0>(collision)) // collision occurred
+            GameObject &box = level.Bricks[i];
+            if (!box.Destroyed)
             {
-                if (!box.IsSolid) // destroy brick
-                {
-                    box.Destroyed = true;
-                }
-
-                // Collision resolution
-
-                Direction dir = std::get<1>(collision);
-                glm::vec2 diff = std::get<2>(collision);
-
-                if (dir == LEFT || dir == RIGHT) // horizontal collision
+                Collision collision = CheckCollision(ball, box);
+                if (std::get<0>(collision)) // collision occurred
                 {
-                    // reverse horizontal direction
-                    Ball->Velocity.x = -Ball->Velocity.x;
-
-                    // push ball out horizontally
-                    float penetration = Ball->Radius - std::abs(diff.x);
-                    if (dir == LEFT) // ball came from right side of brick
+                    if (!box.IsSolid) // destroy brick
                     {
-                        Ball->Position.x += penetration;
+                        box.Destroyed = true;
+                        level.BricksLeft--;
+                        chunk.Version++; // renderer re-uploads chunk
+                        this->spawnPowerUps(box);
+                        Audio.Play(BrickSound, 1.0f, pan);
+                        if (ball.PassThrough) // no bounce
+                            continue;
                     }
-                    else // ball came from left side of brick
+                    else
                     {
-                        Ball->Position.x -= penetration;
+                        ShakeTime = SHAKE_DURATION;
+                        Audio.Play(SolidSound, 1.0f, pan);
                     }
-                }
-                else // vertical collision
-                {
-                    // reverse vertical direction
-                    Ball->Velocity.y = -Ball->Velocity.y;
 
-                    float penetration = Ball->Radius - std::abs(diff.y);
-                    if (dir == UP) // ball came from top of brick
+                    // Collision resolution
+
+                    Direction dir = std::get<1>(collision);
+                    glm::vec2 diff = std::get<2>(collision);
+
+                    if (dir == LEFT || dir == RIGHT) // horizontal collision
                     {
-                        Ball->Position.y -= penetration;
+                        // reverse horizontal direction
+                        ball.Velocity.x = -ball.Velocity.x;
+
+                        // push ball out horizontally
+                        float penetration = ball.Radius - std::abs(diff.x);
+                        if (dir == LEFT) // ball came from right side of brick
+                        {
+                            ball.Position.x += penetration;
+                        }
+                        else // ball came from left side of brick
+                        {
+                            ball.Position.x -= penetration;
+                        }
                     }
-                    else // ball came from bottom of brick
+                    else // vertical collision
                     {
-                        Ball->Position.y += penetration;
+                        // reverse vertical direction
+                        ball.Velocity.y = -ball.Velocity.y;
+
+                        float penetration = ball.Radius - std::abs(diff.y);
+                        if (dir == UP) // ball came from top of brick
+                        {
+                            ball.Position.y -= penetration;
+                        }
+                        else // ball came from bottom of brick
+                        {
+                            ball.Position.y += penetration;
+                        }
                     }
                 }
             }
@@ -291,43 +847,324 @@ void Game::DoCollisions()
     }
 
     // Ball-paddle collision
-    Collision result = CheckCollision(*Ball, *Player);
-    if (!Ball->Stuck && std::get<0>(result))
+    Collision result = CheckCollision(ball, *Player);
+    if (!ball.Stuck && std::get<0>(result))
     {
         float centerPaddle = Player->Position.x + (Player->Size.x/2.0f);
-        float distance = (Ball->Position.x + Ball->Radius) - centerPaddle; // player_center - paddle_center
+        float distance = (ball.Position.x + ball.Radius) - centerPaddle; // player_center - paddle_center
         float percentage = distance / (Player->Size.x / 2.0f); // sign (+/-) indicates which side (left/right) of paddle player is on
 
         // Ball direction changes, but speed stays the same.
         float strength = 2.0f;
-        glm::vec2 oldVelocity = Ball->Velocity;
-        Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-        Ball->Velocity.y = -1.0f * abs(Ball->Velocity.y);
-        Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity);
+        glm::vec2 oldVelocity = ball.Velocity;
+        ball.Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+        ball.Velocity.y = -1.0f * abs(ball.Velocity.y);
+        ball.Velocity = glm::normalize(ball.Velocity) * glm::length(oldVelocity);
+
+        // sticky paddle holds ball until released
+        ball.Stuck = ball.Sticky;
+        Audio.Play(PaddleSound, 1.0f, pan);
+    }
+}
+
+static BallState ballState(const BallObject &ball)
+{
+    BallState state;
+    std::memset(&state, 0, sizeof(state)); // padding too, see StateSnapshot.h
+    state.Position = ball.Position;
+    state.Velocity = ball.Velocity;
+    state.Color = ball.Color;
+    state.Stuck = ball.Stuck;
+    state.Sticky = ball.Sticky;
+    state.PassThrough = ball.PassThrough;
+    return state;
+}
+
+static void restoreBall(BallObject &ball, const BallState &state)
+{
+    ball.Position = state.Position;
+    ball.Velocity = state.Velocity;
+    ball.Color = state.Color;
+    ball.Stuck = state.Stuck;
+    ball.Sticky = state.Sticky;
+    ball.PassThrough = state.PassThrough;
+}
+
+/**
+ * Everything that decides how the sim goes on, brick bits only look at chunks
+ * that changed. Particles are left out.
+ */
+void Game::captureState(std::vector<unsigned char> &state)
+{
+    GameLevel &level = this->Levels[this->Level];
+    LevelBits.Update(level);
+
+    SimState sim;
+    std::memset(&sim, 0, sizeof(sim));
+    sim.State = this->State;
+    sim.Level = this->Level;
+    sim.LevelGeneration = level.Generation;
+    sim.BrickCount = level.Bricks.size();
+    sim.BricksLeft = level.BricksLeft;
+    sim.PlayerPosition = Player->Position;
+    sim.PlayerSize = Player->Size;
+    sim.PlayerColor = Player->Color;
+    sim.Ball = ballState(*Ball);
+    for (unsigned int i = 0; i < ExtraBallCount; i++)
+        sim.ExtraBalls[i] = ballState(ExtraBalls[i]);
+    sim.ExtraBallCount = ExtraBallCount;
+    std::copy(PowerUps.X, PowerUps.X + PowerUps.Count, sim.PowerUpX);
+    std::copy(PowerUps.Y, PowerUps.Y + PowerUps.Count, sim.PowerUpY);
+    std::copy(PowerUps.Type, PowerUps.Type + PowerUps.Count, sim.PowerUpType);
+    sim.PowerUpCount = PowerUps.Count;
+    std::copy(Effects.Remaining, Effects.Remaining + POWERUP_TYPES, sim.EffectsRemaining);
+    sim.PowerUpRandom = PowerUpRandom;
+    sim.ShakeTime = ShakeTime;
+    sim.FlashTime = FlashTime;
+
+    size_t bitBytes = LevelBits.Words.size() * sizeof(uint64_t);
+    state.resize(sizeof(sim) + bitBytes); // same size every tick of a level, no allocation
+    std::memcpy(state.data(), &sim, sizeof(sim));
+    std::memcpy(state.data() + sizeof(sim), LevelBits.Words.data(), bitBytes);
+}
+
+bool Game::restoreState(const std::vector<unsigned char> &state, bool sameRun)
+{
+    SimState sim;
+    if (state.size() < sizeof(sim))
+        return false;
+    std::memcpy(&sim, state.data(), sizeof(sim));
+    if (sim.Level >= this->Levels.size())
+        return false;
+    GameLevel &level = this->Levels[sim.Level];
+    if (sim.BrickCount != level.Bricks.size() || state.size() != sizeof(sim) + BrickBits::WordCount(sim.BrickCount) * sizeof(uint64_t)
+        || (sameRun && sim.LevelGeneration != level.Generation) // level was reloaded since
+        || sim.ExtraBallCount > MAX_EXTRA_BALLS || sim.PowerUpCount > PowerUpPool::CAPACITY
+        || sim.State > GAME_WIN)
+        return false;
+    for (unsigned int i = 0; i < sim.PowerUpCount; i++)
+    {
+        if (sim.PowerUpType[i] >= POWERUP_TYPES) // indexes tables & shifts bits
+            return false;
+    }
+
+    this->State = static_cast<GameState>(sim.State);
+    this->Level = sim.Level;
+    LevelBits.Apply(reinterpret_cast<const uint64_t*>(state.data() + sizeof(sim)), level);
+    level.BricksLeft = sim.BricksLeft;
+    Player->Position = sim.PlayerPosition;
+    Player->Size = sim.PlayerSize;
+    Player->Color = sim.PlayerColor;
+    restoreBall(*Ball, sim.Ball);
+    for (unsigned int i = 0; i < sim.ExtraBallCount; i++)
+    {
+        ExtraBalls[i] = *Ball; // size & sprite
+        restoreBall(ExtraBalls[i], sim.ExtraBalls[i]);
     }
+    ExtraBallCount = sim.ExtraBallCount;
+    std::copy(sim.PowerUpX, sim.PowerUpX + sim.PowerUpCount, PowerUps.X);
+    std::copy(sim.PowerUpY, sim.PowerUpY + sim.PowerUpCount, PowerUps.Y);
+    std::copy(sim.PowerUpType, sim.PowerUpType + sim.PowerUpCount, PowerUps.Type);
+    PowerUps.Count = sim.PowerUpCount;
+    std::copy(sim.EffectsRemaining, sim.EffectsRemaining + POWERUP_TYPES, Effects.Remaining);
+    PowerUpRandom = sim.PowerUpRandom;
+    ShakeTime = sim.ShakeTime;
+    FlashTime = sim.FlashTime;
+    this->updateCamera();
+    return true;
+}
+
+/**
+ * Drops the newest seconds of history and carries on from there, the dropped
+ * future is gone. Costs two decodes at most, whatever the distance.
+ */
+bool Game::Rewind(float seconds)
+{
+    uint64_t tick;
+    if (!History.Rewind(static_cast<unsigned int>(seconds / SIM_STEP + 0.5f), StateBuffer, tick))
+        return false;
+    if (!this->restoreState(StateBuffer, true))
+    {
+        History.Clear(); // from before a level reload
+        return false;
+    }
+    return true;
+}
+
+bool Game::SaveState(const char *file)
+{
+    SteadyFrame::MarkUnsteady();
+    this->captureState(StateBuffer);
+    if (!StateFile::Write(file, StateBuffer))
+        return false;
+    std::cout << "STATE: saved " << file << std::endl;
+    return true;
+}
+
+bool Game::LoadState(const char *file)
+{
+    SteadyFrame::MarkUnsteady();
+    std::vector<unsigned char> state;
+    if (!StateFile::Read(file, state))
+        return false;
+    if (!this->restoreState(state, false))
+    {
+        std::cout << "ERROR::STATE: " << file << " is for another level or invalid" << std::endl;
+        return false;
+    }
+    History.Clear(); // that was another timeline
+    std::cout << "STATE: loaded " << file << std::endl;
+    return true;
 }
 
 void Game::ResetLevel()
 {
-    if (this->Level == 0)
-        this->Levels[0].Load("levels/one.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 1)
-        this->Levels[1].Load("levels/two.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 2)
-        this->Levels[2].Load("levels/three.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 3)
-        this->Levels[3].Load("levels/four.lvl", this->Width, this->Height / 2);
+    this->Levels[this->Level].Reset();
+    PowerUps.Clear();
 }
 
 /**
- * Resets player, and ball.
+ * Resets player, and ball. Ends all power-up effects.
  */
 void Game::ResetPlayer()
 {
-    // Reset player (paddle)
+    // Reset player (paddle), at bottom middle of world
+    glm::vec2 world = this->WorldSize();
     Player->Size = PLAYER_SIZE;
-    Player->Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+    Player->Position = glm::vec2(world.x / 2.0f - PLAYER_SIZE.x / 2.0f, world.y - PLAYER_SIZE.y);
+    Player->Color = glm::vec3(1.0f);
 
     // Reset ball
     Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f), INITIAL_BALL_VELOCITY);
+    Ball->Color = glm::vec3(1.0f);
+    ExtraBallCount = 0;
+    Effects.Clear();
+    ShakeTime = FlashTime = 0.0f;
+}
+
+void Game::spawnPowerUps(const GameObject &brick)
+{
+    for (unsigned int type = 0; type < POWERUP_TYPES; type++)
+    {
+        PowerUpRandom = PowerUpRandom * 1664525u + 1013904223u;
+        if ((PowerUpRandom >> 8) % POWERUP_CHANCE[type] == 0)
+            PowerUps.Spawn(static_cast<PowerUpType>(type), brick.Position);
+    }
+}
+
+void Game::updatePowerUps(float dt)
+{
+    PROFILE_ZONE("Game::updatePowerUps");
+    unsigned int caught = PowerUps.Update(dt, this->WorldSize().y, Player->Position, Player->Position + Player->Size);
+    unsigned int expired = Effects.Update(dt);
+    ShakeTime = std::max(ShakeTime - dt, 0.0f);
+    FlashTime = std::max(FlashTime - dt, 0.0f);
+    if (caught != 0)
+    {
+        FlashTime = FLASH_DURATION;
+        Audio.Play(PowerUpSound);
+    }
+    for (unsigned int type = 0; type < POWERUP_TYPES; type++)
+    {
+        if (expired & (1u << type))
+            this->deactivatePowerUp(static_cast<PowerUpType>(type));
+        if (caught & (1u << type))
+            this->activatePowerUp(static_cast<PowerUpType>(type));
+    }
+}
+
+// keeps direction
+static void setSpeed(BallObject &ball, float speed)
+{
+    if (glm::length(ball.Velocity) > 0.0f)
+        ball.Velocity = glm::normalize(ball.Velocity) * speed;
+}
+
+static void setAllSpeeds(float speed)
+{
+    setSpeed(*Ball, speed);
+    for (unsigned int i = 0; i < ExtraBallCount; i++)
+        setSpeed(ExtraBalls[i], speed);
+}
+
+static void setPassThrough(BallObject &ball, bool passThrough)
+{
+    ball.PassThrough = passThrough;
+    ball.Color = passThrough ? glm::vec3(1.0f, 0.5f, 0.5f) : glm::vec3(1.0f);
+}
+
+// around its center, kept inside world
+static void resizePaddle(float width, float worldWidth)
+{
+    float center = Player->Position.x + Player->Size.x / 2.0f;
+    Player->Size.x = width;
+    Player->Position.x = glm::clamp(center - width / 2.0f, 0.0f, worldWidth - width);
+    if (Ball->Stuck)
+        Ball->Position = Player->Position + glm::vec2(Player->Size.x / 2.0f - Ball->Radius, -Ball->Radius * 2.0f);
+}
+
+void Game::activatePowerUp(PowerUpType type)
+{
+    bool started = Effects.Activate(type); // false: already running, only the timer restarts
+    float speed = glm::length(INITIAL_BALL_VELOCITY);
+    switch (type)
+    {
+        case POWERUP_SPEED:
+            if (started)
+                setAllSpeeds(speed * SPEED_POWERUP_FACTOR);
+            break;
+        case POWERUP_STICKY:
+            Ball->Sticky = true;
+            Player->Color = glm::vec3(1.0f, 0.5f, 1.0f);
+            break;
+        case POWERUP_PASS_THROUGH:
+            setPassThrough(*Ball, true);
+            for (unsigned int i = 0; i < ExtraBallCount; i++)
+                setPassThrough(ExtraBalls[i], true);
+            break;
+        case POWERUP_PADDLE_SIZE:
+            resizePaddle(PLAYER_SIZE.x * PADDLE_POWERUP_FACTOR, this->WorldSize().x);
+            break;
+        case POWERUP_MULTIBALL:
+            // copies of the main ball, fanned out to both sides
+            while (ExtraBallCount < MAX_EXTRA_BALLS)
+            {
+                float angle = ExtraBallCount % 2 == 0 ? 0.5f : -0.5f;
+                glm::vec2 v = Ball->Velocity;
+                BallObject &extra = ExtraBalls[ExtraBallCount++];
+                extra = *Ball;
+                extra.Stuck = false;
+                extra.Sticky = false;
+                extra.Velocity = glm::vec2(v.x * std::cos(angle) - v.y * std::sin(angle), v.x * std::sin(angle) + v.y * std::cos(angle));
+            }
+            break;
+        case POWERUP_CHAOS: // chaos & confuse are screen effects, see PostProcessor
+        case POWERUP_CONFUSE:
+        default:
+            break;
+    }
+}
+
+void Game::deactivatePowerUp(PowerUpType type)
+{
+    switch (type)
+    {
+        case POWERUP_SPEED:
+            setAllSpeeds(glm::length(INITIAL_BALL_VELOCITY));
+            break;
+        case POWERUP_STICKY:
+            Ball->Sticky = false;
+            Player->Color = glm::vec3(1.0f);
+            break;
+        case POWERUP_PASS_THROUGH:
+            setPassThrough(*Ball, false);
+            for (unsigned int i = 0; i < ExtraBallCount; i++)
+                setPassThrough(ExtraBalls[i], false);
+            break;
+        case POWERUP_PADDLE_SIZE:
+            resizePaddle(PLAYER_SIZE.x, this->WorldSize().x);
+            break;
+        default:
+            break;
+    }
 }
\ No newline at end of file
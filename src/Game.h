@@ -2,8 +2,13 @@
 #define GAME_H
 
 #include "GameLevel.h"
+#include "PowerUps.h"
+#include "SpscQueue.h"
 #include <GLFW/glfw3.h>
 
+#include <cstdint>
+#include <tuple>
+
 /**
  * Up is +y
  * Down is -y
@@ -19,6 +24,28 @@ enum Direction {
 	LEFT
 };
 
+class BallObject;
+
+// <collided?, side of the brick the ball hit, vector from ball center to closest point>
+typedef std::tuple<bool, Direction, glm::vec2> Collision;
+
+// collision tests used by DoCollisions
+Direction VectorDirection(glm::vec2 target);
+bool CheckCollision(GameObject &one, GameObject &two); // AABB - AABB
+Collision CheckCollision(BallObject &one, GameObject &two); // circle - AABB
+
+// created by Init/InitWorld, sim thread only once the game is started
+extern GameObject *Player;
+extern BallObject *Ball;
+
+// Key press or release, stamped by the window thread when it arrived
+struct InputEvent
+{
+    int Key;
+    bool Pressed;
+    int64_t TimeNs; // FramePacer::NowNs()
+};
+
 enum GameState
 {
     GAME_ACTIVE,
@@ -30,25 +57,72 @@ class Game
 {
     public:
         GameState State;
-        bool Keys[1024];
+        bool Keys[1024]; // sim thread, kept up to date from Input
+        SpscQueue<InputEvent, 256> Input; // window thread pushes, sim thread consumes
         unsigned int Width, Height;
         std::vector<GameLevel> Levels;
         unsigned int Level;
+        bool ShowOverlay; // performance overlay, render thread (toggled with F3)
+        float RenderScale; // scene resolution (0.5 to 1), 0: adjusts to GPU time, set before Init
+        float GpuBudgetMs; // GPU time per frame dynamic resolution aims to stay within, set before Init
+        std::string AudioFile; // record sound to this .wav instead of discarding it, set before Init
 
         Game(unsigned int width, unsigned int height);
         ~Game();
 
         // loads assets
         void Init();
+        // levels, player and ball only, needs textures but no OpenGL calls (Init calls it)
+        void InitWorld();
+
+        // sim thread: ticks ProcessInput/Update at a fixed rate and publishes snapshots for Render
+        void Start();
+        void Stop();
 
         void DoCollisions();
         void ResetLevel();
         void ResetPlayer();
 
-        // game loop
+        // game loop (ProcessInput & Update on sim thread, Render on render thread)
         void ProcessInput(float dt); // why does this need dt?
         void Update(float dt); // this makes sense why it would need dt.
         void Render();
+        void FramePresented(); // call after swap, measures input latency
+        void Resize(unsigned int width, unsigned int height); // window's framebuffer in pixels, render thread, after Init
+
+        // hot reload assets changed on disk, call on render thread at frame boundary
+        void ReloadAssets();
+
+        // rewind & save states (hold R, F5 quick save, F9 quick load), sim thread
+        bool Rewind(float seconds); // up to REWIND_SECONDS back, false if there is no history
+        bool SaveState(const char *file);
+        bool LoadState(const char *file); // same level (index & brick count) as when saved
+
+        // current level plus space below it for the paddle, never smaller than the screen
+        glm::vec2 WorldSize() const;
+
+    private:
+        void configureShaders(); // sets uniforms that don't change per frame
+        void setView(glm::vec2 camera); // projection for camera position
+        void updateCamera();     // follow ball
+        void movePlayer(float dt); // with keys currently held
+
+        void collideBall(BallObject &ball); // with bricks around it & paddle
+        void spawnPowerUps(const GameObject &brick); // rolls for each type, brick was just destroyed
+        void updatePowerUps(float dt); // fall, catch & expire
+        void activatePowerUp(PowerUpType type);
+        void deactivatePowerUp(PowerUpType type);
+
+        void captureState(std::vector<unsigned char> &state); // SimState & brick bits, see StateSnapshot.h
+        bool restoreState(const std::vector<unsigned char> &state, bool sameRun); // sameRun: from this run's history
+
+        void simulate();         // sim thread loop
+        void publishSnapshot();
+        void reloadLevels();     // level files ReloadAssets handed over
+
+        int64_t inputTimeNs;     // input has been applied up to here
+        int64_t latestInputNs;   // newest event applied, goes into snapshots
+        float simMs;             // duration of last tick, goes into snapshots
 };
 
 #endif
\ No newline at end of file
@@ -1,122 +1,304 @@
 #include "GameLevel.h"
-#include <string>
-#include <fstream>
-#include <sstream>
+#include "Profiler.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// bricks never get smaller than this, levels with many tiles get bigger instead
+const glm::vec2 MIN_BRICK_SIZE(32.0f, 16.0f);
+
+static unsigned int lastGeneration = 0;
 
 GameLevel::GameLevel()
-    : Bricks()
+    : Bricks(), Chunks(), ChunkColumns(0), ChunkRows(0), Size(0.0f), File(), Generation(++lastGeneration), BricksLeft(0), initialDestroyed(), initialBricksLeft(0), cleanVersions(), chunkSize(0.0f)
 {
 }
 
 /**
  * Loads/reloads a level.
  */
-void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight, bool usePack)
 {
     // clear old data
-    this->Bricks.clear();
+    this->clear();
+    this->File = file;
 
-    // load file into vector
-
-    std::ifstream fstream(file);
-    if (fstream)
+    const PackEntry *packed = usePack ? ResourceManager::Pack.Find(file, PACK_LEVEL) : nullptr;
+    if (packed != nullptr)
     {
-        std::string line;
-        std::vector<std::vector<unsigned int>> tileData;
-
-        while (std::getline(fstream, line))
+        // build bricks straight from asset pack
+        LevelData level;
+        if (LevelFile::Parse(ResourceManager::Pack.Data(*packed), packed->Size, level, file))
         {
-            unsigned int tileCode;
-            std::istringstream sstream(line);
-            std::vector<unsigned int> row;
-
-            while (sstream >> tileCode)
-            {
-                row.push_back(tileCode);
-            }
-
-            tileData.push_back(row);
+            this->init(level, levelWidth, levelHeight);
         }
-
-        if (tileData.size() > 0)
+    }
+    else if (LevelFile::IsBinary(file))
+    {
+        // build bricks straight from mapped file
+        LevelFileMapping mapping;
+        if (mapping.Open(file))
         {
-            this->init(tileData, levelWidth, levelHeight);
+            this->init(mapping.Data, levelWidth, levelHeight);
         }
     }
     else
     {
-        std::cout << "ERROR: could not open file: " << file << std::endl;
+        LevelData level = LevelData();
+        std::vector<unsigned char> tiles;
+        if (LevelFile::ReadText(file, tiles, level.Width, level.Height))
+        {
+            level.Tiles = tiles.data();
+            this->init(level, levelWidth, levelHeight);
+        }
+    }
+
+    this->saveInitialState();
+}
+
+void GameLevel::Load(const LevelData &level, unsigned int levelWidth, unsigned int levelHeight)
+{
+    this->clear();
+    this->File.clear(); // not from a file, so never hot reloaded
+
+    this->init(level, levelWidth, levelHeight);
+    this->saveInitialState();
+}
+
+void GameLevel::clear()
+{
+    this->Bricks.clear();
+    this->Chunks.clear();
+    this->ChunkColumns = this->ChunkRows = 0;
+    this->Size = glm::vec2(0.0f);
+    this->BricksLeft = 0;
+    this->Generation = ++lastGeneration;
+}
+
+void GameLevel::saveInitialState()
+{
+    this->initialDestroyed.assign((this->Bricks.size() + 63) / 64, 0);
+    for (unsigned int i = 0; i < this->Bricks.size(); i++)
+    {
+        if (this->Bricks[i].Destroyed)
+            this->initialDestroyed[i / 64] |= uint64_t(1) << (i % 64);
     }
+    this->initialBricksLeft = this->BricksLeft;
+    this->cleanVersions.resize(this->Chunks.size());
+    for (unsigned int c = 0; c < this->Chunks.size(); c++)
+        this->cleanVersions[c] = this->Chunks[c].Version;
 }
 
-void GameLevel::Draw(SpriteRenderer &renderer)
+/**
+ * Play only ever changes Destroyed (and bumps the chunk's Version when it does),
+ * so only chunks whose Version moved since Load or the last Reset are
+ * restored. Never allocates.
+ */
+void GameLevel::Reset()
 {
-    for (GameObject &tile : this->Bricks)
+    for (unsigned int c = 0; c < this->Chunks.size(); c++)
     {
-        if (!tile.Destroyed)
+        LevelChunk &chunk = this->Chunks[c];
+        if (chunk.Version == this->cleanVersions[c])
+            continue;
+        bool changed = false;
+        for (unsigned int i = chunk.First; i < chunk.First + chunk.Count; i++)
         {
-            tile.Draw(renderer);
+            bool destroyed = (this->initialDestroyed[i / 64] >> (i % 64)) & 1;
+            if (this->Bricks[i].Destroyed != destroyed)
+            {
+                this->Bricks[i].Destroyed = destroyed;
+                changed = true;
+            }
         }
+        if (changed)
+            chunk.Version++;
+        this->cleanVersions[c] = chunk.Version;
     }
+    this->BricksLeft = this->initialBricksLeft;
 }
 
-bool GameLevel::IsCompleted()
+void GameLevel::Snapshot(glm::vec2 viewMin, glm::vec2 viewMax, FrameSnapshot &frame)
+{
+    PROFILE_ZONE("GameLevel::Snapshot");
+    frame.LevelGeneration = this->Generation;
+    frame.ChunkCount = this->Chunks.size();
+    frame.Chunks.clear();
+    frame.Bricks.clear();
+
+    this->FindChunks(viewMin, viewMax, this->visibleChunks);
+    // upper bound up front, so scrolling over a denser part grows the vectors once, not brick by brick
+    unsigned int bricks = 0;
+    for (unsigned int index : this->visibleChunks)
+        bricks += this->Chunks[index].Count;
+    frame.Chunks.reserve(this->visibleChunks.size());
+    frame.Bricks.reserve(bricks);
+    for (unsigned int index : this->visibleChunks)
+    {
+        const LevelChunk &chunk = this->Chunks[index];
+        ChunkSnapshot copy = { index, chunk.Version, static_cast<unsigned int>(frame.Bricks.size()), 0 };
+
+        for (unsigned int i = chunk.First; i < chunk.First + chunk.Count; i++)
+        {
+            const GameObject &brick = this->Bricks[i];
+            if (!brick.Destroyed)
+                frame.Bricks.push_back(BrickInstance{ brick.Position, brick.Size, brick.Color, brick.IsSolid ? 1.0f : 0.0f });
+        }
+
+        copy.Count = frame.Bricks.size() - copy.First;
+        frame.Chunks.push_back(copy);
+    }
+}
+
+/**
+ * Chunks form a grid, so only the chunks under [min, max] are looked at.
+ */
+void GameLevel::FindChunks(glm::vec2 min, glm::vec2 max, std::vector<unsigned int> &chunks) const
 {
-    for (GameObject &tile : this->Bricks)
+    chunks.clear();
+    if (this->Chunks.empty())
+        return;
+
+    // grid cells covered, clamped to level
+    glm::vec2 first = glm::floor(min / this->chunkSize);
+    glm::vec2 last = glm::floor(max / this->chunkSize);
+    if (last.x < 0.0f || last.y < 0.0f || first.x >= this->ChunkColumns || first.y >= this->ChunkRows)
+        return;
+    unsigned int x0 = static_cast<unsigned int>(std::max(first.x, 0.0f));
+    unsigned int y0 = static_cast<unsigned int>(std::max(first.y, 0.0f));
+    unsigned int x1 = std::min(static_cast<unsigned int>(last.x), this->ChunkColumns - 1);
+    unsigned int y1 = std::min(static_cast<unsigned int>(last.y), this->ChunkRows - 1);
+
+    for (unsigned int y = y0; y <= y1; y++)
     {
-        if (!tile.IsSolid && !tile.Destroyed)
+        for (unsigned int x = x0; x <= x1; x++)
         {
-            return false;
+            unsigned int index = y * this->ChunkColumns + x;
+            const LevelChunk &chunk = this->Chunks[index];
+            bool overlaps = chunk.Count > 0
+                && chunk.Min.x <= max.x && min.x <= chunk.Max.x
+                && chunk.Min.y <= max.y && min.y <= chunk.Max.y;
+            if (overlaps)
+                chunks.push_back(index);
         }
     }
+}
 
-    return true;
+bool GameLevel::IsCompleted()
+{
+    return this->BricksLeft == 0;
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+/**
+ * Default color of breakable bricks (tile codes 2 - 5).
+ */
+static glm::vec3 brickColor(unsigned char tileCode)
+{
+    if (tileCode == 2)
+        return glm::vec3(0.2f, 0.6f, 1.0f);
+    else if (tileCode == 3)
+        return glm::vec3(0.0f, 0.7f, 0.0f);
+    else if (tileCode == 4)
+        return glm::vec3(0.8f, 0.8f, 0.4f);
+    else if (tileCode == 5)
+        return glm::vec3(1.0f, 0.5f, 0.0f);
+    return glm::vec3(1.0f);
+}
+
+void GameLevel::init(const LevelData &level, unsigned int levelWidth, unsigned int levelHeight)
 {
     // IDEA: could add offset for top left of level
     //       would be useful for adding margin around level.
 
-    unsigned int rows = tileData.size(); // number of rows
-    unsigned int columns = tileData[0].size(); // number of columns
-    float brickWidth = levelWidth / static_cast<float>(columns);
-    float brickHeight = levelHeight / static_cast<float>(rows);
+    unsigned int rows = level.Height; // number of rows
+    unsigned int columns = level.Width; // number of columns
+    size_t tileCount = static_cast<size_t>(rows) * columns;
+    if (tileCount == 0)
+        return;
+    float brickWidth = std::max(levelWidth / static_cast<float>(columns), MIN_BRICK_SIZE.x);
+    float brickHeight = std::max(levelHeight / static_cast<float>(rows), MIN_BRICK_SIZE.y);
+    this->Size = glm::vec2(brickWidth * columns, brickHeight * rows);
+
+    this->ChunkColumns = (columns + CHUNK_TILES - 1) / CHUNK_TILES;
+    this->ChunkRows = (rows + CHUNK_TILES - 1) / CHUNK_TILES;
+    this->chunkSize = glm::vec2(brickWidth, brickHeight) * static_cast<float>(CHUNK_TILES);
+    this->Chunks.resize(static_cast<size_t>(this->ChunkColumns) * this->ChunkRows);
+
+    // allocate once
+    size_t brickCount = 0;
+    for (size_t i = 0; i < tileCount; i++)
+    {
+        if (level.Tiles[i] != 0)
+            brickCount++;
+    }
+    this->Bricks.reserve(brickCount);
+
+    // look textures up once, not per brick
+    TextureView solidTexture = ResourceManager::GetTexture("block_solid");
+    TextureView blockTexture = ResourceManager::GetTexture("block");
 
-    for (unsigned int y = 0; y < rows; ++y) // rows
+    // bricks of a chunk end up next to each other
+    LevelChunk *chunk = this->Chunks.data();
+    for (unsigned int chunkY = 0; chunkY < this->ChunkRows; ++chunkY)
     {
-        for (unsigned int x = 0; x < columns; ++x) // columns
+        for (unsigned int chunkX = 0; chunkX < this->ChunkColumns; ++chunkX, ++chunk)
         {
-            if (tileData[y][x] == 1) // solid brick
+            unsigned int x0 = chunkX * CHUNK_TILES, x1 = std::min(x0 + CHUNK_TILES, columns);
+            unsigned int y0 = chunkY * CHUNK_TILES, y1 = std::min(y0 + CHUNK_TILES, rows);
+
+            chunk->First = this->Bricks.size();
+            this->initChunk(level, x0, y0, x1, y1, glm::vec2(brickWidth, brickHeight), solidTexture, blockTexture);
+            chunk->Count = this->Bricks.size() - chunk->First;
+
+            // bounding box
+            if (chunk->Count > 0)
             {
-                glm::vec2 pos(brickWidth * x, brickHeight * y);
-                glm::vec2 size(brickWidth, brickHeight);
+                chunk->Min = this->Bricks[chunk->First].Position;
+                chunk->Max = chunk->Min;
+                for (unsigned int i = chunk->First; i < chunk->First + chunk->Count; i++)
+                {
+                    chunk->Min = glm::min(chunk->Min, this->Bricks[i].Position);
+                    chunk->Max = glm::max(chunk->Max, this->Bricks[i].Position + this->Bricks[i].Size);
+                }
+            }
+        }
+    }
+}
 
-                GameObject brick(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f,0.8f,0.7f));
-                brick.IsSolid = true;
-                this->Bricks.push_back(brick);
+/**
+ * Adds bricks for tiles [x0, x1) x [y0, y1).
+ */
+void GameLevel::initChunk(const LevelData &level, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, glm::vec2 brickSize, TextureView solidTexture, TextureView blockTexture)
+{
+    for (unsigned int y = y0; y < y1; ++y) // rows
+    {
+        const unsigned char *tile = level.Tiles + static_cast<size_t>(y) * level.Width + x0;
+        for (unsigned int x = x0; x < x1; ++x, ++tile) // columns
+        {
+            unsigned char tileCode = *tile;
+            if (tileCode == 0) // empty space, so do nothing
+                continue;
+
+            glm::vec3 color;
+            if (tileCode < level.PaletteSize)
+                color = glm::vec3(level.Palette[tileCode * 3], level.Palette[tileCode * 3 + 1], level.Palette[tileCode * 3 + 2]);
+            else if (tileCode == 1)
+                color = glm::vec3(0.8f, 0.8f, 0.7f);
+            else
+                color = brickColor(tileCode);
+
+            glm::vec2 pos(brickSize.x * x, brickSize.y * y);
+
+            if (tileCode == 1) // solid brick
+            {
+                this->Bricks.emplace_back(pos, brickSize, solidTexture, color);
+                this->Bricks.back().IsSolid = true;
             }
-            else if (tileData[y][x] > 1) // breakable brick
+            else // breakable brick
             {
-                glm::vec3 color = glm::vec3(1.0f); 
-                if (tileData[y][x] == 2)
-                    color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
-                    color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
-                    color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
-                    color = glm::vec3(1.0f, 0.5f, 0.0f);
-                
-                glm::vec2 pos(brickWidth * x, brickHeight * y);
-                glm::vec2 size(brickWidth, brickHeight);
-                GameObject brick(pos, size, ResourceManager::GetTexture("block"), color);
-                this->Bricks.push_back(brick);
+                this->Bricks.emplace_back(pos, brickSize, blockTexture, color);
+                this->BricksLeft++;
             }
-            // else tile code is 0
-                // empty space, so do nothing
         }
     }
-}
\ No newline at end of file
+}
@@ -1,26 +1,56 @@
 #ifndef GAMELEVEL_H
 #define GAMELEVEL_H
 
+#include <cstdint>
 #include <vector>
+#include <string>
 #include <glm/glm.hpp>
 
 #include "GameObject.h"
-#include "SpriteRenderer.h"
+#include "FrameSnapshot.h"
+#include "LevelChunk.h"
 #include "ResourceManager.h"
+#include "LevelFile.h"
 
+/**
+ * Bricks are grouped into chunks (see LevelChunk.h), so drawing and collision
+ * only have to look at the chunks in a given area, however big the level is.
+ */
 class GameLevel
 {
     public:
-        std::vector<GameObject> Bricks;
+        std::vector<GameObject> Bricks; // ordered chunk by chunk
+        std::vector<LevelChunk> Chunks; // row by row, ChunkColumns per row
+        unsigned int ChunkColumns, ChunkRows;
+        glm::vec2 Size; // in pixels, may be bigger than the screen
+        std::string File; // file level was loaded from
+        unsigned int Generation; // new for every load, so old chunk indices can be told apart
+        unsigned int BricksLeft; // breakable bricks not destroyed yet, whoever destroys one decrements it
 
         GameLevel();
 
-        void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
-        void Draw(SpriteRenderer &renderer);
+        // .lvl text or .blvl binary, taken from ResourceManager's asset pack if it has it.
+        // Small levels are stretched to levelWidth x levelHeight, big ones grow past it.
+        void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight, bool usePack = true);
+        void Load(const LevelData &level, unsigned int levelWidth, unsigned int levelHeight); // already in memory (e.g. LevelGenerator)
+        void Reset(); // back to state right after Load, no file I/O or allocation
+        void Snapshot(glm::vec2 viewMin, glm::vec2 viewMax, FrameSnapshot &frame); // copies live bricks of chunks in view
         bool IsCompleted();
 
+        // indices of non-empty chunks overlapping [min, max], replaces contents of chunks
+        void FindChunks(glm::vec2 min, glm::vec2 max, std::vector<unsigned int> &chunks) const;
+
     private:
-        void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
+        std::vector<uint64_t> initialDestroyed; // Destroyed flags right after Load, one bit per brick
+        unsigned int initialBricksLeft;
+        std::vector<unsigned int> cleanVersions; // chunk Versions when bricks last matched initialDestroyed
+        glm::vec2 chunkSize; // in pixels
+        std::vector<unsigned int> visibleChunks; // reused by Draw
+
+        void clear();
+        void saveInitialState();
+        void init(const LevelData &level, unsigned int levelWidth, unsigned int levelHeight);
+        void initChunk(const LevelData &level, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, glm::vec2 brickSize, TextureView solidTexture, TextureView blockTexture);
 };
 
 #endif
\ No newline at end of file
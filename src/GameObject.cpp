@@ -5,7 +5,7 @@ GameObject::GameObject()
 {
 }
 
-GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color, glm::vec2 velocity)
+GameObject::GameObject(glm::vec2 pos, glm::vec2 size, TextureView sprite, glm::vec3 color, glm::vec2 velocity)
     : Position(pos), Size(size), Sprite(sprite), Color(color), Velocity(velocity), Rotation(0.0f), IsSolid(false), Destroyed(false)
 {
 }
@@ -19,10 +19,10 @@ class GameObject
         float Rotation;
         bool IsSolid;
         bool Destroyed;
-        Texture2D Sprite;
+        TextureView Sprite; // texture is owned by ResourceManager
 
         GameObject();
-        GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
+        GameObject(glm::vec2 pos, glm::vec2 size, TextureView sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
 
         virtual void Draw(SpriteRenderer &renderer);
 };
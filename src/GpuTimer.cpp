@@ -0,0 +1,49 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer()
+    : next(0), pending(0), measuring(false)
+{
+    for (GLQuery &query : this->queries)
+    {
+        unsigned int id;
+        glGenQueries(1, &id);
+        query.Reset(id);
+    }
+}
+
+void GpuTimer::Begin()
+{
+    this->measuring = this->pending < QUERIES;
+    if (this->measuring)
+        glBeginQuery(GL_TIME_ELAPSED, this->queries[this->next].Get());
+}
+
+void GpuTimer::End()
+{
+    if (!this->measuring)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    this->next = (this->next + 1) % QUERIES;
+    this->pending++;
+    this->measuring = false;
+}
+
+bool GpuTimer::Read(float &ms)
+{
+    bool read = false;
+    while (this->pending > 0)
+    {
+        unsigned int oldest = (this->next + QUERIES - this->pending) % QUERIES;
+        GLint available = 0;
+        glGetQueryObjectiv(this->queries[oldest].Get(), GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break; // later ones can't be done either
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(this->queries[oldest].Get(), GL_QUERY_RESULT, &ns);
+        ms = ns / 1e6f;
+        this->pending--;
+        read = true;
+    }
+    return read;
+}
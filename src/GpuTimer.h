@@ -0,0 +1,32 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+#include "GLObject.h"
+
+/**
+ * Measures GPU time of a stretch of GL calls with GL_TIME_ELAPSED queries.
+ * Results arrive a few frames late; queries go round a small ring and Read only
+ * takes finished ones, so measuring never waits for the GPU. When all queries
+ * are still in flight a frame simply isn't measured.
+ */
+class GpuTimer
+{
+    public:
+        static const unsigned int QUERIES = 4; // frames in flight
+
+        GpuTimer();
+
+        void Begin();
+        void End();
+        bool Read(float &ms); // newest finished measurement since last Read, false if none
+
+    private:
+        GLQuery queries[QUERIES];
+        unsigned int next;    // query the next Begin uses
+        unsigned int pending; // begun & not read yet, oldest is next - pending
+        bool measuring;       // between Begin & End with a query
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef LEVEL_CHUNK_H
+#define LEVEL_CHUNK_H
+
+#include <glm/glm.hpp>
+
+// Side length, in tiles, of the square pieces a level is split into
+const unsigned int CHUNK_TILES = 32;
+
+/**
+ * A CHUNK_TILES x CHUNK_TILES piece of a level. Its bricks are stored next to each
+ * other in GameLevel::Bricks. The renderer keeps a GPU copy per chunk and only
+ * refreshes it when Version changed (see ChunkRenderer).
+ */
+struct LevelChunk
+{
+    unsigned int First, Count;  // bricks [First, First + Count) of GameLevel::Bricks
+    glm::vec2 Min, Max;         // bounding box of its bricks
+    unsigned int Version;       // bumped whenever one of its bricks changes
+
+    LevelChunk() : First(0), Count(0), Min(0.0f), Max(0.0f), Version(0) { }
+};
+
+#endif
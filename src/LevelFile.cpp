@@ -0,0 +1,300 @@
+#include "LevelFile.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(sizeof(LevelFileHeader) == 32, "unexpected level file header size");
+
+const char LEVEL_MAGIC[4] = { 'B', 'L', 'V', 'L' };
+const uint32_t LEVEL_VERSION = 1;
+
+LevelFileMapping::LevelFileMapping()
+    : Data(), mapping(nullptr), mappingSize(0)
+{
+}
+
+LevelFileMapping::~LevelFileMapping()
+{
+    this->Close();
+}
+
+bool LevelFileMapping::Open(const char *file)
+{
+    this->Close();
+
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+    {
+        std::cout << "ERROR: could not open file: " << file << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(LevelFileHeader)))
+    {
+        std::cout << "ERROR: not a binary level file: " << file << std::endl;
+        close(fd);
+        return false;
+    }
+
+    void *base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // mapping stays valid
+    if (base == MAP_FAILED)
+    {
+        std::cout << "ERROR: could not map file: " << file << std::endl;
+        return false;
+    }
+    this->mapping = base;
+    this->mappingSize = st.st_size;
+
+    if (!LevelFile::Parse(static_cast<const unsigned char*>(base), this->mappingSize, this->Data, file))
+    {
+        this->Close();
+        return false;
+    }
+
+    // tiles will be read front to back once
+    madvise(base, this->mappingSize, MADV_SEQUENTIAL);
+    return true;
+}
+
+void LevelFileMapping::Close()
+{
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->mappingSize);
+
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->Data = LevelData();
+}
+
+bool LevelFile::IsBinary(const char *file)
+{
+    size_t length = std::strlen(file);
+    return length >= 5 && std::strcmp(file + length - 5, ".blvl") == 0;
+}
+
+bool LevelFile::Parse(const unsigned char *data, size_t size, LevelData &level, const char *file)
+{
+    if (size < sizeof(LevelFileHeader))
+    {
+        std::cout << "ERROR: not a binary level file: " << file << std::endl;
+        return false;
+    }
+
+    const LevelFileHeader *header = reinterpret_cast<const LevelFileHeader*>(data);
+    const unsigned char *body = data + sizeof(LevelFileHeader);
+    size_t bodySize = size - sizeof(LevelFileHeader);
+    size_t paletteBytes = static_cast<size_t>(header->PaletteSize) * 3 * sizeof(float);
+    size_t tileBytes = static_cast<size_t>(header->Width) * header->Height;
+
+    if (std::memcmp(header->Magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0 || header->Version != LEVEL_VERSION)
+    {
+        std::cout << "ERROR: not a binary level file: " << file << std::endl;
+        return false;
+    }
+    if (paletteBytes + tileBytes != bodySize || Checksum(body, bodySize) != header->Checksum)
+    {
+        std::cout << "ERROR: corrupt level file: " << file << std::endl;
+        return false;
+    }
+
+    level.Width = header->Width;
+    level.Height = header->Height;
+    level.PaletteSize = header->PaletteSize;
+    level.Palette = header->PaletteSize > 0 ? reinterpret_cast<const float*>(body) : nullptr;
+    level.Tiles = body + paletteBytes;
+    return true;
+}
+
+/**
+ * Rows are lines of whitespace separated tile codes, blank lines are skipped. Width is
+ * taken from the first row, shorter rows are padded with empty tiles and longer ones
+ * are cut off.
+ */
+bool LevelFile::ReadText(const char *file, std::vector<unsigned char> &tiles, unsigned int &width, unsigned int &height)
+{
+    tiles.clear();
+    width = 0;
+    height = 0;
+
+    FILE *in = std::fopen(file, "rb");
+    if (in == nullptr)
+    {
+        std::cout << "ERROR: could not open file: " << file << std::endl;
+        return false;
+    }
+
+    // read whole file at once, no per line streams
+    std::vector<char> text;
+    char buffer[64 * 1024];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), in)) > 0)
+        text.insert(text.end(), buffer, buffer + n);
+    std::fclose(in);
+
+    unsigned int column = 0;
+    bool inRow = false;   // current line has content
+    bool inNumber = false;
+    unsigned int code = 0;
+
+    for (size_t i = 0; i <= text.size(); i++)
+    {
+        char c = i < text.size() ? text[i] : '\n';
+
+        if (c >= '0' && c <= '9')
+        {
+            code = code * 10 + (c - '0');
+            inNumber = true;
+            inRow = true;
+            if (code > 255)
+            {
+                std::cout << "ERROR: tile code out of range in file: " << file << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        if (inNumber) // end of a tile code
+        {
+            if (height == 0)
+                tiles.push_back(static_cast<unsigned char>(code));
+            else if (column < width)
+                tiles[static_cast<size_t>(height) * width + column] = static_cast<unsigned char>(code);
+            column++;
+            code = 0;
+            inNumber = false;
+        }
+
+        if (c == '\n')
+        {
+            if (!inRow) // blank line
+                continue;
+
+            if (height == 0)
+                width = column;
+
+            height++;
+            tiles.resize(static_cast<size_t>(height + 1) * width, 0); // room for next row
+            column = 0;
+            inRow = false;
+        }
+        else if (c != ' ' && c != '\t' && c != '\r')
+        {
+            std::cout << "ERROR: unexpected character in level file: " << file << std::endl;
+            return false;
+        }
+    }
+
+    // drop room for row that never came
+    tiles.resize(static_cast<size_t>(height) * width);
+    return width > 0 && height > 0;
+}
+
+/**
+ * One row per line, codes separated by spaces, like the hand-written levels.
+ */
+bool LevelFile::WriteText(const char *file, const LevelData &level)
+{
+    FILE *out = std::fopen(file, "wb");
+    if (out == nullptr)
+    {
+        std::cout << "ERROR: could not write file: " << file << std::endl;
+        return false;
+    }
+
+    std::string line;
+    bool ok = true;
+    const unsigned char *tile = level.Tiles;
+    for (unsigned int y = 0; y < level.Height && ok; y++)
+    {
+        line.clear();
+        for (unsigned int x = 0; x < level.Width; x++, tile++)
+        {
+            if (x > 0)
+                line += ' ';
+            line += std::to_string(*tile);
+        }
+        if (y + 1 < level.Height)
+            line += '\n';
+        ok = std::fwrite(line.data(), 1, line.size(), out) == line.size();
+    }
+    ok = std::fclose(out) == 0 && ok;
+
+    if (!ok)
+        std::cout << "ERROR: could not write file: " << file << std::endl;
+    return ok;
+}
+
+bool LevelFile::WriteBinary(const char *file, const LevelData &level)
+{
+    std::vector<unsigned char> contents;
+    Serialize(level, contents);
+
+    FILE *out = std::fopen(file, "wb");
+    if (out == nullptr)
+    {
+        std::cout << "ERROR: could not write file: " << file << std::endl;
+        return false;
+    }
+
+    bool ok = std::fwrite(contents.data(), 1, contents.size(), out) == contents.size();
+    ok = std::fclose(out) == 0 && ok;
+
+    if (!ok)
+        std::cout << "ERROR: could not write file: " << file << std::endl;
+    return ok;
+}
+
+void LevelFile::Serialize(const LevelData &level, std::vector<unsigned char> &out)
+{
+    size_t paletteBytes = static_cast<size_t>(level.PaletteSize) * 3 * sizeof(float);
+    size_t tileBytes = static_cast<size_t>(level.Width) * level.Height;
+
+    out.resize(sizeof(LevelFileHeader) + paletteBytes + tileBytes);
+    unsigned char *body = out.data() + sizeof(LevelFileHeader);
+
+    // checksum covers palette followed by tiles
+    if (paletteBytes > 0)
+        std::memcpy(body, level.Palette, paletteBytes);
+    std::memcpy(body + paletteBytes, level.Tiles, tileBytes);
+
+    LevelFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.Magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    header.Version = LEVEL_VERSION;
+    header.Width = level.Width;
+    header.Height = level.Height;
+    header.PaletteSize = level.PaletteSize;
+    header.Checksum = Checksum(body, paletteBytes + tileBytes);
+    std::memcpy(out.data(), &header, sizeof(header));
+}
+
+/**
+ * FNV-1a, 8 bytes at a time (still byte order dependent, files aren't meant to be portable).
+ */
+uint64_t LevelFile::Checksum(const unsigned char *data, size_t length)
+{
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    for (; i < length; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
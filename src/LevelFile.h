@@ -0,0 +1,77 @@
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Binary level format (.blvl):
+ *
+ *   LevelFileHeader
+ *   palette: PaletteSize x (r, g, b) floats, color of tile code i (optional)
+ *   tiles:   Width x Height bytes, row by row, same codes as .lvl text files
+ *
+ * Checksum is FNV-1a over everything after the header.
+ */
+struct LevelFileHeader
+{
+    char Magic[4];          // "BLVL"
+    uint32_t Version;
+    uint32_t Width, Height; // in tiles
+    uint32_t PaletteSize;   // 0 = use default brick colors
+    uint32_t Reserved;
+    uint64_t Checksum;
+};
+
+// Tiles & palette of a level, either pointing into a mapped .blvl file or into memory owned by caller
+struct LevelData
+{
+    unsigned int Width, Height;
+    const unsigned char *Tiles;
+    unsigned int PaletteSize;
+    const float *Palette;
+};
+
+// A memory-mapped .blvl file
+class LevelFileMapping
+{
+    public:
+        LevelData Data;
+
+        LevelFileMapping();
+        ~LevelFileMapping();
+
+        bool Open(const char *file); // maps and validates file, prints error on failure
+        void Close();
+
+    private:
+        void *mapping;
+        size_t mappingSize;
+
+        LevelFileMapping(const LevelFileMapping&);
+        LevelFileMapping& operator=(const LevelFileMapping&);
+};
+
+class LevelFile
+{
+    public:
+        static bool IsBinary(const char *file); // has .blvl extension
+
+        // validates .blvl contents already in memory, level points into data afterwards
+        static bool Parse(const unsigned char *data, size_t size, LevelData &level, const char *file);
+
+        // .lvl text --> flat tile array (row by row), prints error on failure
+        static bool ReadText(const char *file, std::vector<unsigned char> &tiles, unsigned int &width, unsigned int &height);
+
+        static bool WriteText(const char *file, const LevelData &level); // palette is dropped
+        static bool WriteBinary(const char *file, const LevelData &level);
+        static void Serialize(const LevelData &level, std::vector<unsigned char> &out); // .blvl contents
+
+        static uint64_t Checksum(const unsigned char *data, size_t length);
+
+    private:
+        LevelFile();
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include "LevelGenerator.h"
+
+#include <algorithm>
+#include <utility>
+
+LevelGeneratorSettings::LevelGeneratorSettings()
+    : Width(15), Height(8), Seed(1), Pattern(PATTERN_NOISE), Density(0.7f), SolidRatio(0.1f), ColorWeights{ 1.0f, 1.0f, 1.0f, 1.0f }
+{
+}
+
+// splitmix64, tiny & good enough for level layouts
+class Random
+{
+    public:
+        Random(uint64_t seed) : state(seed) { }
+
+        uint64_t Next()
+        {
+            uint64_t z = (this->state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        // [0, 1), from top 24 bits so float rounding can't reach 1
+        float NextFloat()
+        {
+            return (this->Next() >> 40) * (1.0f / 16777216.0f);
+        }
+
+        unsigned int NextBelow(unsigned int n)
+        {
+            return static_cast<unsigned int>(this->Next() % n);
+        }
+
+    private:
+        uint64_t state;
+};
+
+/**
+ * Tile code for a tile that has a brick.
+ */
+static unsigned char brickCode(Random &random, const LevelGeneratorSettings &settings, float colorTotal)
+{
+    if (random.NextFloat() < settings.SolidRatio)
+        return 1;
+
+    float pick = random.NextFloat() * colorTotal;
+    for (unsigned char i = 0; i < 3; i++)
+    {
+        float weight = std::max(settings.ColorWeights[i], 0.0f);
+        if (pick < weight)
+            return 2 + i;
+        pick -= weight;
+    }
+    return 5;
+}
+
+static unsigned char tileCode(Random &random, const LevelGeneratorSettings &settings, float colorTotal)
+{
+    if (random.NextFloat() >= settings.Density)
+        return 0;
+    return brickCode(random, settings, colorTotal);
+}
+
+/**
+ * Walls of a maze carved by depth-first search, cells sit on odd coordinates.
+ */
+static void generateMaze(Random &random, const LevelGeneratorSettings &settings, float colorTotal, std::vector<unsigned char> &tiles)
+{
+    unsigned int width = settings.Width, height = settings.Height;
+    std::vector<bool> open(tiles.size(), false);
+
+    unsigned int cellsX = width / 2, cellsY = height / 2; // cell (cx, cy) is tile (2cx + 1, 2cy + 1)
+    if (cellsX > 0 && cellsY > 0)
+    {
+        std::vector<std::pair<unsigned int, unsigned int>> stack; // explicit stack, levels can be huge
+        std::vector<bool> visited(static_cast<size_t>(cellsX) * cellsY, false);
+        stack.emplace_back(random.NextBelow(cellsX), random.NextBelow(cellsY));
+        visited[static_cast<size_t>(stack.back().second) * cellsX + stack.back().first] = true;
+        open[static_cast<size_t>(2 * stack.back().second + 1) * width + 2 * stack.back().first + 1] = true;
+
+        const int dx[4] = { 1, -1, 0, 0 };
+        const int dy[4] = { 0, 0, 1, -1 };
+        while (!stack.empty())
+        {
+            unsigned int cx = stack.back().first, cy = stack.back().second;
+
+            // unvisited neighbours
+            unsigned int candidates[4], count = 0;
+            for (unsigned int d = 0; d < 4; d++)
+            {
+                long nx = static_cast<long>(cx) + dx[d], ny = static_cast<long>(cy) + dy[d];
+                if (nx >= 0 && ny >= 0 && nx < cellsX && ny < cellsY && !visited[static_cast<size_t>(ny) * cellsX + nx])
+                    candidates[count++] = d;
+            }
+            if (count == 0)
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            // knock down wall between cell and a random neighbour
+            unsigned int d = candidates[random.NextBelow(count)];
+            unsigned int nx = cx + dx[d], ny = cy + dy[d];
+            visited[static_cast<size_t>(ny) * cellsX + nx] = true;
+            open[static_cast<size_t>(2 * cy + 1 + dy[d]) * width + 2 * cx + 1 + dx[d]] = true;
+            open[static_cast<size_t>(2 * ny + 1) * width + 2 * nx + 1] = true;
+            stack.emplace_back(nx, ny);
+        }
+    }
+
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        if (!open[i] && random.NextFloat() < settings.Density)
+            tiles[i] = brickCode(random, settings, colorTotal);
+    }
+}
+
+LevelData LevelGenerator::Generate(const LevelGeneratorSettings &settings, std::vector<unsigned char> &tiles)
+{
+    tiles.assign(static_cast<size_t>(settings.Width) * settings.Height, 0);
+
+    Random random(settings.Seed);
+    float colorTotal = 0.0f;
+    for (float weight : settings.ColorWeights)
+        colorTotal += std::max(weight, 0.0f);
+
+    if (settings.Pattern == PATTERN_MAZE)
+    {
+        generateMaze(random, settings, colorTotal, tiles);
+    }
+    else if (settings.Pattern == PATTERN_SYMMETRIC)
+    {
+        unsigned int half = (settings.Width + 1) / 2;
+        for (unsigned int y = 0; y < settings.Height; y++)
+        {
+            unsigned char *row = tiles.data() + static_cast<size_t>(y) * settings.Width;
+            for (unsigned int x = 0; x < half; x++)
+            {
+                row[x] = tileCode(random, settings, colorTotal);
+                row[settings.Width - 1 - x] = row[x];
+            }
+        }
+    }
+    else // noise
+    {
+        for (unsigned char &tile : tiles)
+            tile = tileCode(random, settings, colorTotal);
+    }
+
+    LevelData level = LevelData();
+    level.Width = settings.Width;
+    level.Height = settings.Height;
+    level.Tiles = tiles.data();
+    return level;
+}
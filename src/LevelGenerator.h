@@ -0,0 +1,44 @@
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "LevelFile.h"
+
+enum LevelPattern
+{
+    PATTERN_NOISE,     // every tile on its own
+    PATTERN_MAZE,      // bricks are the walls of a maze
+    PATTERN_SYMMETRIC  // noise mirrored left to right
+};
+
+struct LevelGeneratorSettings
+{
+    unsigned int Width, Height; // in tiles
+    uint64_t Seed;
+    LevelPattern Pattern;
+    float Density;          // chance a tile (maze: wall tile) has a brick
+    float SolidRatio;       // chance a brick is solid
+    float ColorWeights[4];  // relative chance of breakable brick codes 2 - 5
+
+    LevelGeneratorSettings();
+};
+
+/**
+ * Procedural levels for benchmarks and testing.
+ *
+ * Same settings give the same level on every platform: the generator uses its own
+ * random number generator (splitmix64), not <random>'s distributions.
+ */
+class LevelGenerator
+{
+    public:
+        // fills tiles, returned level points into it
+        static LevelData Generate(const LevelGeneratorSettings &settings, std::vector<unsigned char> &tiles);
+
+    private:
+        LevelGenerator();
+};
+
+#endif
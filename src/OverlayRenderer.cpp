@@ -0,0 +1,260 @@
+#include "OverlayRenderer.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+
+static_assert(sizeof(OverlayVertex) == 8 * sizeof(float), "overlay vertices must be tightly packed");
+
+// 5x7 glyphs for ASCII 32 - 95, one byte per row from the top, bit 4 is the leftmost pixel
+const unsigned int FONT_FIRST = 32, FONT_COUNT = 64;
+const unsigned char FONT[FONT_COUNT][7] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // !
+    { 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 }, // "
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // #
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // $
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // &
+    { 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // *
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // +
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ,
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+    { 0x01, 0x02, 0x02, 0x04, 0x08, 0x08, 0x10 }, // /
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ;
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // <
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // =
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // >
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // ?
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // @
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // A
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // Y
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+    { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // [
+    { 0x10, 0x08, 0x08, 0x04, 0x02, 0x02, 0x01 }, // backslash
+    { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ]
+    { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }  // _
+};
+
+// atlas: 16 x 5 cells of 8x8 pixels, glyphs in the first 64, cell 64 is solid
+const unsigned int CELL = 8, ATLAS_COLUMNS = 16, ATLAS_ROWS = 5;
+const unsigned int ATLAS_WIDTH = CELL * ATLAS_COLUMNS, ATLAS_HEIGHT = CELL * ATLAS_ROWS;
+const unsigned int SOLID_CELL = FONT_COUNT;
+
+// layout, in screen pixels
+const float GLYPH_SCALE = 2.0f;
+const float ADVANCE = 6.0f * GLYPH_SCALE;
+const float LINE_HEIGHT = 9.0f * GLYPH_SCALE;
+const glm::vec2 PANEL_POSITION(8.0f, 8.0f);
+const float PADDING = 8.0f;
+const float PANEL_WIDTH = 26.0f * ADVANCE; // longest line
+const float GRAPH_HEIGHT = 60.0f;
+const float GRAPH_MAX_MS = 100.0f / 3.0f; // top of graph, two 60 Hz frames
+const unsigned int LINES = 8;
+const size_t LINE_LENGTH = 64;
+
+OverlayRenderer::OverlayRenderer(ShaderHandle shader)
+    : shader(shader), vertices(ArenaAllocator<OverlayVertex>(RenderArena.Current())), frameTimes(), frameIndex(0)
+{
+    this->buildAtlas();
+
+    // create ids (owned, deleted with renderer)
+    unsigned int VAO, VBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    this->VAO.Reset(VAO);
+    this->VBO.Reset(VBO);
+
+    glBindVertexArray(this->VAO.Get());
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO.Get());
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, Vertex));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, Color));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void OverlayRenderer::buildAtlas()
+{
+    std::vector<unsigned char> pixels(ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+    for (unsigned int glyph = 0; glyph <= SOLID_CELL; glyph++)
+    {
+        unsigned int cellX = glyph % ATLAS_COLUMNS * CELL, cellY = glyph / ATLAS_COLUMNS * CELL;
+        for (unsigned int y = 0; y < CELL; y++)
+        {
+            for (unsigned int x = 0; x < CELL; x++)
+            {
+                bool set = glyph == SOLID_CELL || (y < 7 && x < 5 && (FONT[glyph][y] >> (4 - x)) & 1);
+                pixels[(cellY + y) * ATLAS_WIDTH + cellX + x] = set ? 255 : 0;
+            }
+        }
+    }
+
+    this->atlas.Internal_Format = GL_RED;
+    this->atlas.Image_Format = GL_RED;
+    this->atlas.Wrap_S = GL_CLAMP_TO_EDGE;
+    this->atlas.Wrap_T = GL_CLAMP_TO_EDGE;
+    this->atlas.Filter_Min = GL_NEAREST;
+    this->atlas.Filter_Max = GL_NEAREST;
+    this->atlas.Generate(ATLAS_WIDTH, ATLAS_HEIGHT, pixels.data()); // rows are 128 bytes, fine for default unpack alignment
+}
+
+void OverlayRenderer::AddFrameTime(float ms)
+{
+    this->frameTimes[this->frameIndex] = ms;
+    this->frameIndex = (this->frameIndex + 1) % GRAPH_SAMPLES;
+}
+
+void OverlayRenderer::Update(const OverlayStats &stats)
+{
+    // fresh every frame from the render arena, reserved up front so it never grows into a second block
+    this->vertices = ArenaVector<OverlayVertex>(ArenaAllocator<OverlayVertex>(RenderArena.Current()));
+    this->vertices.reserve(6 * (2 + LINES * (LINE_LENGTH - 1) + GRAPH_SAMPLES)); // panel, text, graph & 60 Hz line
+
+    char line[LINE_LENGTH];
+    float width = PANEL_WIDTH;
+    float barWidth = width / GRAPH_SAMPLES;
+    glm::vec2 origin = PANEL_POSITION + PADDING;
+
+    // background panel
+    glm::vec2 panelMax = origin + glm::vec2(width, LINES * LINE_HEIGHT + GRAPH_HEIGHT) + PADDING;
+    this->rect(PANEL_POSITION, panelMax, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+
+    // text
+    glm::vec4 white(1.0f), grey(0.7f, 0.7f, 0.7f, 1.0f);
+    float fps = stats.FrameMs > 0.0f ? 1000.0f / stats.FrameMs : 0.0f;
+    std::snprintf(line, sizeof(line), "FRAME %6.2f MS %5.0f FPS", stats.FrameMs, fps);
+    this->text(origin, line, white);
+    std::snprintf(line, sizeof(line), "SIM   %6.2f MS", stats.SimMs);
+    this->text(origin + glm::vec2(0.0f, LINE_HEIGHT), line, white);
+    std::snprintf(line, sizeof(line), "GPU   %6.2f MS %3.0f%% %s", stats.GpuMs, stats.RenderScale * 100.0f, stats.ScalePinned ? "FIXED" : "AUTO");
+    this->text(origin + glm::vec2(0.0f, 2 * LINE_HEIGHT), line, white);
+    std::snprintf(line, sizeof(line), "DRAW CALLS %u", stats.DrawCalls);
+    this->text(origin + glm::vec2(0.0f, 3 * LINE_HEIGHT), line, white);
+    std::snprintf(line, sizeof(line), "PARTICLES  %u", stats.Particles);
+    this->text(origin + glm::vec2(0.0f, 4 * LINE_HEIGHT), line, white);
+    std::snprintf(line, sizeof(line), "BRICKS     %u", stats.BricksLeft);
+    this->text(origin + glm::vec2(0.0f, 5 * LINE_HEIGHT), line, white);
+    if (stats.AllocationsTracked)
+        std::snprintf(line, sizeof(line), "ALLOCS %llu RENDER %llu SIM", static_cast<unsigned long long>(stats.RenderAllocations), static_cast<unsigned long long>(stats.SimAllocations));
+    else
+        std::snprintf(line, sizeof(line), "ALLOCS NOT TRACKED");
+    this->text(origin + glm::vec2(0.0f, 6 * LINE_HEIGHT), line, stats.RenderAllocations + stats.SimAllocations > 0 ? glm::vec4(1.0f, 0.4f, 0.4f, 1.0f) : white);
+    std::snprintf(line, sizeof(line), "OVERLAY %.3f MS (F3)", stats.OverlayMs);
+    this->text(origin + glm::vec2(0.0f, 7 * LINE_HEIGHT), line, grey);
+
+    // frame time graph, oldest on the left, line at 60 Hz
+    glm::vec2 graphMin = origin + glm::vec2(0.0f, LINES * LINE_HEIGHT);
+    glm::vec2 graphMax = graphMin + glm::vec2(width, GRAPH_HEIGHT);
+    for (unsigned int i = 0; i < GRAPH_SAMPLES; i++)
+    {
+        float ms = this->frameTimes[(this->frameIndex + i) % GRAPH_SAMPLES];
+        float height = std::min(ms / GRAPH_MAX_MS, 1.0f) * GRAPH_HEIGHT;
+        glm::vec4 color = ms <= 1000.0f / 60.0f + 1.0f ? glm::vec4(0.2f, 0.9f, 0.2f, 1.0f)
+                        : ms <= GRAPH_MAX_MS ? glm::vec4(0.9f, 0.8f, 0.1f, 1.0f)
+                        : glm::vec4(0.9f, 0.2f, 0.2f, 1.0f);
+        float x = graphMin.x + i * barWidth;
+        this->rect(glm::vec2(x, graphMax.y - height), glm::vec2(x + barWidth, graphMax.y), color);
+    }
+    float target = graphMax.y - (1000.0f / 60.0f) / GRAPH_MAX_MS * GRAPH_HEIGHT;
+    this->rect(glm::vec2(graphMin.x, target), glm::vec2(graphMax.x, target + 1.0f), glm::vec4(1.0f, 1.0f, 1.0f, 0.5f));
+}
+
+void OverlayRenderer::Draw()
+{
+    if (this->vertices.empty())
+        return;
+
+    ResourceManager::GetShader(this->shader).Use();
+    glActiveTexture(GL_TEXTURE0);
+    this->atlas.Bind();
+
+    glBindVertexArray(this->VAO.Get());
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO.Get());
+    glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(OverlayVertex), this->vertices.data(), GL_STREAM_DRAW); // orphans last frame's
+    glDrawArrays(GL_TRIANGLES, 0, this->vertices.size());
+    RenderStats::DrawCalls++;
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void OverlayRenderer::quad(glm::vec2 min, glm::vec2 max, glm::vec2 uvMin, glm::vec2 uvMax, glm::vec4 color)
+{
+    OverlayVertex topLeft     = { glm::vec4(min.x, min.y, uvMin.x, uvMin.y), color };
+    OverlayVertex topRight    = { glm::vec4(max.x, min.y, uvMax.x, uvMin.y), color };
+    OverlayVertex bottomLeft  = { glm::vec4(min.x, max.y, uvMin.x, uvMax.y), color };
+    OverlayVertex bottomRight = { glm::vec4(max.x, max.y, uvMax.x, uvMax.y), color };
+
+    this->vertices.push_back(topLeft);
+    this->vertices.push_back(bottomRight);
+    this->vertices.push_back(bottomLeft);
+    this->vertices.push_back(topLeft);
+    this->vertices.push_back(topRight);
+    this->vertices.push_back(bottomRight);
+}
+
+void OverlayRenderer::rect(glm::vec2 min, glm::vec2 max, glm::vec4 color)
+{
+    // center of the solid cell, nearest filtering never reaches a neighbour
+    glm::vec2 solid((SOLID_CELL % ATLAS_COLUMNS * CELL + CELL / 2.0f) / ATLAS_WIDTH, (SOLID_CELL / ATLAS_COLUMNS * CELL + CELL / 2.0f) / ATLAS_HEIGHT);
+    this->quad(min, max, solid, solid, color);
+}
+
+void OverlayRenderer::text(glm::vec2 position, const char *text, glm::vec4 color)
+{
+    glm::vec2 glyphSize = glm::vec2(5.0f, 7.0f) * GLYPH_SCALE;
+    for (const char *c = text; *c != '\0'; c++, position.x += ADVANCE)
+    {
+        unsigned int code = std::toupper(static_cast<unsigned char>(*c));
+        if (code <= FONT_FIRST || code >= FONT_FIRST + FONT_COUNT) // space or no glyph
+            continue;
+
+        unsigned int glyph = code - FONT_FIRST;
+        glm::vec2 uvMin(static_cast<float>(glyph % ATLAS_COLUMNS * CELL) / ATLAS_WIDTH, static_cast<float>(glyph / ATLAS_COLUMNS * CELL) / ATLAS_HEIGHT);
+        glm::vec2 uvMax = uvMin + glm::vec2(5.0f / ATLAS_WIDTH, 7.0f / ATLAS_HEIGHT);
+        this->quad(position, position + glyphSize, uvMin, uvMax, color);
+    }
+}
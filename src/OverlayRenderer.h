@@ -0,0 +1,72 @@
+#ifndef OVERLAY_RENDERER_H
+#define OVERLAY_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Texture.h"
+#include "GLObject.h"
+#include "ResourceManager.h"
+#include "FrameArena.h"
+
+// What the overlay shows, gathered by Game::Render
+struct OverlayStats
+{
+    float FrameMs;        // since previous frame
+    float SimMs;          // last sim tick, without publishing
+    unsigned int DrawCalls;
+    unsigned int Particles;
+    unsigned int BricksLeft;
+    float OverlayMs;      // CPU time the overlay itself took last frame
+    bool AllocationsTracked; // built with the allocation tracker
+    uint64_t RenderAllocations, SimAllocations; // previous frame & tick
+    float GpuMs;          // scene on the GPU, a few frames old
+    float RenderScale;    // scene resolution per axis
+    bool ScalePinned;     // fixed with --scale, else dynamic
+};
+
+struct OverlayVertex
+{
+    glm::vec4 Vertex; // <vec2 pos, vec2 texCoord>
+    glm::vec4 Color;
+};
+
+/**
+ * Performance overlay: a few lines of text and a rolling frame time graph,
+ * batched into one vertex buffer and drawn with a single draw call.
+ *
+ * Text uses a built-in 5x7 bitmap font (upper case, digits, some punctuation),
+ * baked into a small single channel atlas. One atlas cell is solid, so the
+ * panel and graph bars are drawn as untextured quads in the same batch.
+ */
+class OverlayRenderer
+{
+    public:
+        OverlayRenderer(ShaderHandle shader);
+
+        void AddFrameTime(float ms); // every frame, also while hidden
+        void Update(const OverlayStats &stats); // rebuilds vertices, no GL calls
+        void Draw(); // screen space, projection set by Game::configureShaders
+
+    private:
+        static const unsigned int GRAPH_SAMPLES = 120;
+
+        ShaderHandle shader;
+        Texture2D atlas;
+        GLVertexArray VAO;
+        GLBuffer VBO;
+
+        ArenaVector<OverlayVertex> vertices; // current frame's, in RenderArena, Update to Draw only
+        float frameTimes[GRAPH_SAMPLES];
+        unsigned int frameIndex; // next sample to overwrite, oldest one
+
+        void buildAtlas();
+        void quad(glm::vec2 min, glm::vec2 max, glm::vec2 uvMin, glm::vec2 uvMax, glm::vec4 color);
+        void rect(glm::vec2 min, glm::vec2 max, glm::vec4 color); // solid
+        void text(glm::vec2 position, const char *text, glm::vec4 color);
+};
+
+#endif
@@ -1,27 +1,34 @@
 #include "ParticleGenerator.h"
+#include "Profiler.h"
+#include "RenderStats.h"
 
 Particle::Particle()
     : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f)
 {
 }
 
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-    : shader(shader), texture(texture), amount(amount)
+ParticleGenerator::ParticleGenerator(ShaderHandle shader, TextureView texture, unsigned int amount)
+    : shader(shader), texture(texture), amount(amount), maxLive(amount), spawnScale(1.0f), spawnBacklog(0.0f)
 {
     this->init();
 }
 
 void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset)
 {
+    PROFILE_ZONE("ParticleGenerator::Update");
     // add new particles
-    for (unsigned int i = 0; i < newParticles; i++)
+    this->spawnBacklog += newParticles * this->spawnScale;
+    unsigned int spawnCount = static_cast<unsigned int>(this->spawnBacklog);
+    this->spawnBacklog -= spawnCount;
+
+    for (unsigned int i = 0; i < spawnCount; i++)
     {
         unsigned int unusedParticle = this->firstUnusedParticle();
         this->respawnParticle(this->particles[unusedParticle], object, offset);
     }
 
     // update all particles
-    for (unsigned int i = 0; i < this->amount; i++)
+    for (unsigned int i = 0; i < this->maxLive; i++)
     {
         Particle& p = this->particles[i];
         p.Life -= dt;
@@ -33,25 +40,36 @@ void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newPar
     }
 }
 
-void ParticleGenerator::Draw()
+void ParticleGenerator::Snapshot(std::vector<Particle> &live) const
 {
+    live.clear();
+    live.reserve(this->amount); // once per snapshot slot, not every time more particles are alive
+    for (unsigned int i = 0; i < this->maxLive; i++)
+    {
+        if (this->particles[i].Life > 0.0f) // ITS ALIVE
+            live.push_back(this->particles[i]);
+    }
+}
+
+void ParticleGenerator::Draw(const std::vector<Particle> &live)
+{
+    PROFILE_ZONE("ParticleGenerator::Draw");
     // draw set up
     glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    this->shader.Use();
+    Shader &shader = ResourceManager::GetShader(this->shader);
+    shader.Use();
     this->texture.Bind();
-    glBindVertexArray(this->VAO);
+    glBindVertexArray(this->VAO.Get());
 
     // draw particles
-    for (Particle& p : this->particles) // little p, big P
+    for (const Particle &p : live) // little p, big P
     {
-        if (p.Life > 0.0f) // ITS ALIVE
-        {
-            this->shader.SetVector2f("offset", p.Position);
-            this->shader.SetVector4f("color", p.Color);
+        shader.SetVector2f("offset", p.Position);
+        shader.SetVector4f("color", p.Color);
 
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-        }
+        glDrawArrays(GL_TRIANGLES, 0, 6);
     }
+    RenderStats::DrawCalls += live.size();
 
     // restore pre-draw opengl state
     glBindVertexArray(0);
@@ -70,15 +88,16 @@ void ParticleGenerator::init()
         1.0f, 0.0f, 1.0f, 0.0f
     };
 
-    unsigned int VBO;
-
-    // create ids
-    glGenVertexArrays(1, &this->VAO);
+    // create ids (owned, deleted with generator)
+    unsigned int VAO, VBO;
+    glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    this->VAO.Reset(VAO);
+    this->VBO.Reset(VBO);
     
     // bind
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindVertexArray(this->VAO.Get());
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO.Get());
 
     // fill buffer
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
@@ -97,11 +116,33 @@ void ParticleGenerator::init()
     }
 }
 
+void ParticleGenerator::SetMaxLive(unsigned int maxLive)
+{
+    if (maxLive > this->amount)
+        maxLive = this->amount;
+
+    // kill particles in slots that are no longer simulated
+    for (unsigned int i = maxLive; i < this->maxLive; i++)
+    {
+        this->particles[i].Life = 0.0f;
+    }
+
+    this->maxLive = maxLive;
+}
+
+void ParticleGenerator::SetSpawnScale(float scale)
+{
+    this->spawnScale = scale;
+}
+
 unsigned int lastUsedParticle = 0;
 unsigned int ParticleGenerator::firstUnusedParticle()
 {
+    if (lastUsedParticle >= this->maxLive)
+        lastUsedParticle = 0;
+
     // likely that last unused particle is next to other unused particles
-    for (unsigned int i = lastUsedParticle; i < this->amount; i++)
+    for (unsigned int i = lastUsedParticle; i < this->maxLive; i++)
     {
         if (this->particles[i].Life <= 0.0f)
         {
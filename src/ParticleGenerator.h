@@ -8,7 +8,9 @@
 
 #include "Shader.h"
 #include "Texture.h"
+#include "GLObject.h"
 #include "GameObject.h"
+#include "ResourceManager.h"
 
 struct Particle
 {
@@ -22,18 +24,27 @@ struct Particle
 class ParticleGenerator
 {
     public:
-        ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount);
+        ParticleGenerator(ShaderHandle shader, TextureView texture, unsigned int amount);
 
         void Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
-        void Draw();
+        void Snapshot(std::vector<Particle> &live) const; // copies live particles, replaces contents of live
+        void Draw(const std::vector<Particle> &live); // particles from a Snapshot
+
+        // limits used to scale particle cost back (see ParticleGovernor)
+        void SetMaxLive(unsigned int maxLive);
+        void SetSpawnScale(float scale);
 
     private:
         std::vector<Particle> particles;
         unsigned int amount;
-
-        Shader shader;
-        Texture2D texture;
-        unsigned int VAO;
+        unsigned int maxLive; // only slots [0, maxLive) are simulated & drawn
+        float spawnScale;
+        float spawnBacklog; // fractional particles carried over to next update
+
+        ShaderHandle shader; // handle, so generator picks up reloaded shaders
+        TextureView texture;
+        GLVertexArray VAO;
+        GLBuffer VBO;
 
         void init();
         unsigned int firstUnusedParticle();
@@ -0,0 +1,95 @@
+#include "ParticleGovernor.h"
+
+#include <iostream>
+
+// fraction of full spawn rate & particle count per quality level
+const float QUALITY_SCALE[ParticleGovernor::QUALITY_LEVELS] = { 0.1f, 0.25f, 0.5f, 0.75f, 1.0f };
+
+const float SMOOTHING = 0.1f;         // weight of newest frame in smoothed estimate
+const float UPGRADE_THRESHOLD = 0.6f; // fraction of budget we must stay under to raise quality
+const unsigned int DOWNGRADE_FRAMES = 10;
+const unsigned int UPGRADE_FRAMES = 120;
+
+ParticleGovernor::ParticleGovernor(float budgetMs, unsigned int maxParticles)
+    : budgetMs(budgetMs), maxParticles(maxParticles), smoothedMs(0.0f), frameMs(0.0f), level(QUALITY_LEVELS - 1), throttleCount(0), framesOver(0), framesUnder(0)
+{
+}
+
+void ParticleGovernor::BeginSample()
+{
+    this->sampleStart = std::chrono::steady_clock::now();
+}
+
+void ParticleGovernor::EndSample()
+{
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - this->sampleStart;
+    this->frameMs += elapsed.count();
+}
+
+void ParticleGovernor::AddSample(float ms)
+{
+    this->frameMs += ms;
+}
+
+void ParticleGovernor::EndFrame()
+{
+    this->smoothedMs += (this->frameMs - this->smoothedMs) * SMOOTHING;
+    this->frameMs = 0.0f;
+
+    if (this->smoothedMs > this->budgetMs)
+    {
+        this->framesUnder = 0;
+        this->framesOver++;
+    }
+    else if (this->smoothedMs < this->budgetMs * UPGRADE_THRESHOLD)
+    {
+        this->framesOver = 0;
+        this->framesUnder++;
+    }
+    else // in between, hold current level
+    {
+        this->framesOver = 0;
+        this->framesUnder = 0;
+    }
+
+    if (this->framesOver >= DOWNGRADE_FRAMES && this->level > 0)
+    {
+        this->level--;
+        this->throttleCount++;
+        this->framesOver = 0;
+        std::cout << "PARTICLES: over budget (" << this->smoothedMs << " ms), quality lowered to " << this->level
+            << " (throttled " << this->throttleCount << " times)" << std::endl;
+    }
+    else if (this->framesUnder >= UPGRADE_FRAMES && this->level < QUALITY_LEVELS - 1)
+    {
+        this->level++;
+        this->framesUnder = 0;
+        std::cout << "PARTICLES: under budget (" << this->smoothedMs << " ms), quality raised to " << this->level << std::endl;
+    }
+}
+
+unsigned int ParticleGovernor::QualityLevel() const
+{
+    return this->level;
+}
+
+unsigned int ParticleGovernor::ThrottleCount() const
+{
+    return this->throttleCount;
+}
+
+float ParticleGovernor::SmoothedMs() const
+{
+    return this->smoothedMs;
+}
+
+float ParticleGovernor::SpawnScale() const
+{
+    return QUALITY_SCALE[this->level];
+}
+
+unsigned int ParticleGovernor::MaxLive() const
+{
+    unsigned int maxLive = static_cast<unsigned int>(this->maxParticles * QUALITY_SCALE[this->level]);
+    return maxLive > 0 ? maxLive : 1;
+}
@@ -0,0 +1,50 @@
+#ifndef PARTICLE_GOVERNOR_H
+#define PARTICLE_GOVERNOR_H
+
+#include <chrono>
+
+/**
+ * Keeps particle update + draw time within a millisecond budget.
+ *
+ * Time spent on particles is sampled every frame and smoothed. When the smoothed
+ * time stays over budget the quality level is lowered (less spawning, fewer live
+ * particles). It is only raised again once the time has stayed well under budget
+ * for a while, so quality doesn't flip-flop around the limit.
+ */
+class ParticleGovernor
+{
+    public:
+        static const unsigned int QUALITY_LEVELS = 5; // 0 = lowest, QUALITY_LEVELS - 1 = full
+
+        ParticleGovernor(float budgetMs, unsigned int maxParticles);
+
+        // time a block of particle work (update or draw), can be called several times per frame
+        void BeginSample();
+        void EndSample();
+        void AddSample(float ms); // work timed elsewhere (e.g. drawing on render thread)
+
+        // call once per frame, after all particle work was sampled
+        void EndFrame();
+
+        unsigned int QualityLevel() const;
+        unsigned int ThrottleCount() const; // how many times quality was lowered
+        float SmoothedMs() const;
+
+        float SpawnScale() const; // multiplier for number of spawned particles
+        unsigned int MaxLive() const; // max number of live particles
+
+    private:
+        float budgetMs;
+        unsigned int maxParticles;
+
+        float smoothedMs;
+        float frameMs;
+        std::chrono::steady_clock::time_point sampleStart;
+
+        unsigned int level;
+        unsigned int throttleCount;
+        unsigned int framesOver;  // consecutive frames over budget
+        unsigned int framesUnder; // consecutive frames well under budget
+};
+
+#endif
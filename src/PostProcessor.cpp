@@ -0,0 +1,104 @@
+#include "PostProcessor.h"
+#include "AllocTracker.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+PostProcessor::PostProcessor(ShaderHandle shader, unsigned int viewWidth, unsigned int viewHeight)
+    : shader(shader), aspect(static_cast<float>(viewWidth) / viewHeight), scale(1.0f), output(0, 0, viewWidth, viewHeight)
+{
+    // color buffer, clamped so upscaling doesn't blend in the opposite edge (chaos wraps in post.fs)
+    this->scene.Internal_Format = GL_RGB;
+    this->scene.Image_Format = GL_RGB;
+    this->scene.Wrap_S = GL_CLAMP_TO_EDGE;
+    this->scene.Wrap_T = GL_CLAMP_TO_EDGE;
+    this->scene.Generate(viewWidth, viewHeight, nullptr);
+
+    unsigned int FBO, VAO;
+    glGenFramebuffers(1, &FBO);
+    glGenVertexArrays(1, &VAO);
+    this->FBO.Reset(FBO);
+    this->VAO.Reset(VAO);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO.Get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->scene.ID.Get(), 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+ * Largest rectangle with the view's aspect ratio that fits, centered.
+ */
+void PostProcessor::Resize(unsigned int framebufferWidth, unsigned int framebufferHeight)
+{
+    if (framebufferWidth == 0 || framebufferHeight == 0)
+        return;
+
+    int width = framebufferWidth, height = framebufferHeight;
+    if (width > height * this->aspect)
+        width = static_cast<int>(std::lround(height * this->aspect));
+    else
+        height = static_cast<int>(std::lround(width / this->aspect));
+    this->output = glm::ivec4((framebufferWidth - width) / 2, (framebufferHeight - height) / 2, width, height);
+    this->resizeScene();
+}
+
+void PostProcessor::SetScale(float scale)
+{
+    this->scale = scale;
+    this->resizeScene();
+}
+
+void PostProcessor::resizeScene()
+{
+    unsigned int width = std::max(1L, std::lround(this->output.z * this->scale));
+    unsigned int height = std::max(1L, std::lround(this->output.w * this->scale));
+    if (width == this->scene.Width && height == this->scene.Height)
+        return;
+
+    SteadyFrame::MarkUnsteady(); // driver allocates the new storage
+    this->scene.Generate(width, height, nullptr); // same texture, stays attached
+}
+
+bool PostProcessor::Begin(const PostEffects &effects)
+{
+    bool scaled = this->scene.Width != static_cast<unsigned int>(this->output.z) || this->scene.Height != static_cast<unsigned int>(this->output.w);
+    if (!effects.Any() && !scaled)
+    {
+        glViewport(this->output.x, this->output.y, this->output.z, this->output.w);
+        return false;
+    }
+
+    this->effects = effects;
+    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO.Get());
+    glViewport(0, 0, this->scene.Width, this->scene.Height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return true;
+}
+
+void PostProcessor::End(float time)
+{
+    PROFILE_ZONE("PostProcessor::End");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(this->output.x, this->output.y, this->output.z, this->output.w);
+
+    Shader &shader = ResourceManager::GetShader(this->shader);
+    shader.Use();
+    shader.SetFloat("time", time);
+    shader.SetInteger("shake", this->effects.Shake);
+    shader.SetInteger("chaos", this->effects.Chaos);
+    shader.SetInteger("confuse", this->effects.Confuse);
+    shader.SetFloat("flash", this->effects.Flash);
+
+    glActiveTexture(GL_TEXTURE0);
+    this->scene.Bind();
+    glBindVertexArray(this->VAO.Get());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    RenderStats::DrawCalls++;
+    glBindVertexArray(0);
+}
@@ -0,0 +1,50 @@
+#ifndef POST_PROCESSOR_H
+#define POST_PROCESSOR_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Texture.h"
+#include "GLObject.h"
+#include "FrameSnapshot.h"
+#include "ResourceManager.h"
+
+/**
+ * Gets the scene onto the window: screen effects (shake, chaos, confuse, flash)
+ * and resolution scaling in a single pass. The scene is drawn into an offscreen
+ * framebuffer, then one fullscreen triangle applies all active effects at once,
+ * picked by uniform flags, and upscales (bilinear) to the output. With no
+ * effect active and the scale at 1 Begin returns false and the scene goes
+ * straight to the window, no extra pass.
+ *
+ * The output keeps the view's aspect ratio, centered in the window's
+ * framebuffer with black bars on the sides that don't fit. All sizes here are
+ * in framebuffer pixels, which on HiDPI displays is more than window size.
+ */
+class PostProcessor
+{
+    public:
+        PostProcessor(ShaderHandle shader, unsigned int viewWidth, unsigned int viewHeight); // view: aspect ratio to keep
+
+        void Resize(unsigned int framebufferWidth, unsigned int framebufferHeight); // window's, 0 (minimized) is ignored
+        void SetScale(float scale); // scene resolution per axis, reallocates the buffer if its size changes
+        float Scale() const { return this->scale; }
+
+        // viewport is set to where the scene goes, true: offscreen, draw the scene, then call End
+        bool Begin(const PostEffects &effects);
+        void End(float time); // seconds, drives shake & chaos. Leaves the output viewport set
+
+    private:
+        ShaderHandle shader;
+        float aspect; // of the view
+        float scale;
+        glm::ivec4 output; // <x, y, width, height> in the window's framebuffer
+        GLFramebuffer FBO;
+        Texture2D scene;
+        GLVertexArray VAO; // empty, the triangle comes from gl_VertexID
+        PostEffects effects; // of frame between Begin and End
+
+        void resizeScene(); // to output * scale
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "PowerUpRenderer.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+
+#include <cstddef>
+
+PowerUpRenderer::PowerUpRenderer(ShaderHandle shader, TextureView block, TextureView solid)
+    : shader(shader), block(block), solid(solid)
+{
+    float vertices[] = {
+        // pos      // tex
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f
+    };
+
+    unsigned int VAO, buffers[2];
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(2, buffers);
+    this->VAO.Reset(VAO);
+    this->quadVBO.Reset(buffers[0]);
+    this->instances.Reset(buffers[1]);
+
+    glBindVertexArray(this->VAO.Get());
+
+    // quad per vertex, power-up per instance, same as ChunkRenderer
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO.Get());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->instances.Get());
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (void*)offsetof(BrickInstance, Position));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (void*)offsetof(BrickInstance, Color));
+    glVertexAttribDivisor(2, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void PowerUpRenderer::Draw(const std::vector<BrickInstance> &powerUps)
+{
+    PROFILE_ZONE("PowerUpRenderer::Draw");
+    if (powerUps.empty())
+        return;
+
+    ResourceManager::GetShader(this->shader).Use();
+    glActiveTexture(GL_TEXTURE0);
+    this->block.Bind();
+    glActiveTexture(GL_TEXTURE1);
+    this->solid.Bind();
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(this->VAO.Get());
+    glBindBuffer(GL_ARRAY_BUFFER, this->instances.Get());
+    glBufferData(GL_ARRAY_BUFFER, powerUps.size() * sizeof(BrickInstance), powerUps.data(), GL_STREAM_DRAW); // orphans last frame's
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, powerUps.size());
+    RenderStats::DrawCalls++;
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,32 @@
+#ifndef POWER_UP_RENDERER_H
+#define POWER_UP_RENDERER_H
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "FrameSnapshot.h"
+#include "GLObject.h"
+#include "ResourceManager.h"
+
+/**
+ * Draws all falling power-ups of a snapshot with one instanced draw call. They
+ * come as BrickInstances, so this uses the brick shader and its vertex layout.
+ * Lives on the render thread.
+ */
+class PowerUpRenderer
+{
+    public:
+        PowerUpRenderer(ShaderHandle shader, TextureView block, TextureView solid);
+
+        void Draw(const std::vector<BrickInstance> &powerUps);
+
+    private:
+        ShaderHandle shader; // handle, so renderer picks up reloaded shaders
+        TextureView block, solid;
+        GLVertexArray VAO;
+        GLBuffer quadVBO, instances;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "PowerUps.h"
+
+const unsigned int POWERUP_CHANCE[POWERUP_TYPES] = { 40, 40, 40, 40, 60, 20, 25 };
+const float POWERUP_DURATION[POWERUP_TYPES] = { 10.0f, 20.0f, 10.0f, 15.0f, 0.0f, 8.0f, 6.0f };
+const glm::vec3 POWERUP_COLOR[POWERUP_TYPES] = {
+    glm::vec3(0.5f, 0.5f, 1.0f),  // speed
+    glm::vec3(1.0f, 0.5f, 1.0f),  // sticky
+    glm::vec3(0.5f, 1.0f, 0.5f),  // pass-through
+    glm::vec3(1.0f, 0.6f, 0.4f),  // paddle size
+    glm::vec3(1.0f, 1.0f, 0.4f),  // multiball
+    glm::vec3(0.9f, 0.25f, 0.25f), // chaos
+    glm::vec3(1.0f, 0.3f, 0.6f)    // confuse
+};
+
+const glm::vec2 POWERUP_SIZE(60.0f, 20.0f);
+const float POWERUP_FALL_SPEED = 150.0f;
+
+PowerUpPool::PowerUpPool()
+    : Count(0)
+{
+}
+
+bool PowerUpPool::Spawn(PowerUpType type, glm::vec2 position)
+{
+    if (this->Count == CAPACITY)
+        return false;
+    this->X[this->Count] = position.x;
+    this->Y[this->Count] = position.y;
+    this->Type[this->Count] = type;
+    this->Count++;
+    return true;
+}
+
+/**
+ * Plain loops over the arrays, the fall loop vectorizes. Removing swaps the last
+ * one in, so the paddle test goes backwards to not skip it.
+ */
+unsigned int PowerUpPool::Update(float dt, float bottom, glm::vec2 paddleMin, glm::vec2 paddleMax)
+{
+    float fall = POWERUP_FALL_SPEED * dt;
+    for (unsigned int i = 0; i < this->Count; i++)
+        this->Y[i] += fall;
+
+    unsigned int caught = 0;
+    for (unsigned int i = this->Count; i-- > 0; )
+    {
+        bool hit = this->X[i] <= paddleMax.x && paddleMin.x <= this->X[i] + POWERUP_SIZE.x
+                && this->Y[i] <= paddleMax.y && paddleMin.y <= this->Y[i] + POWERUP_SIZE.y;
+        if (hit)
+            caught |= 1u << this->Type[i];
+        if (hit || this->Y[i] >= bottom)
+            this->remove(i);
+    }
+    return caught;
+}
+
+void PowerUpPool::Clear()
+{
+    this->Count = 0;
+}
+
+void PowerUpPool::Snapshot(std::vector<BrickInstance> &instances) const
+{
+    instances.clear();
+    instances.reserve(CAPACITY); // once per snapshot slot
+    for (unsigned int i = 0; i < this->Count; i++)
+        instances.push_back(BrickInstance{ glm::vec2(this->X[i], this->Y[i]), POWERUP_SIZE, POWERUP_COLOR[this->Type[i]], 0.0f });
+}
+
+void PowerUpPool::remove(unsigned int i)
+{
+    unsigned int last = --this->Count;
+    this->X[i] = this->X[last];
+    this->Y[i] = this->Y[last];
+    this->Type[i] = this->Type[last];
+}
+
+PowerUpEffects::PowerUpEffects()
+{
+    this->Clear();
+}
+
+bool PowerUpEffects::Activate(PowerUpType type)
+{
+    bool wasActive = this->Active(type);
+    this->Remaining[type] = POWERUP_DURATION[type];
+    return !wasActive;
+}
+
+unsigned int PowerUpEffects::Update(float dt)
+{
+    unsigned int expired = 0;
+    for (unsigned int type = 0; type < POWERUP_TYPES; type++)
+    {
+        if (this->Remaining[type] <= 0.0f)
+            continue;
+        this->Remaining[type] -= dt;
+        if (this->Remaining[type] <= 0.0f)
+        {
+            this->Remaining[type] = 0.0f;
+            expired |= 1u << type;
+        }
+    }
+    return expired;
+}
+
+void PowerUpEffects::Clear()
+{
+    for (unsigned int type = 0; type < POWERUP_TYPES; type++)
+        this->Remaining[type] = 0.0f;
+}
@@ -0,0 +1,70 @@
+#ifndef POWER_UPS_H
+#define POWER_UPS_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "FrameSnapshot.h"
+
+enum PowerUpType
+{
+    POWERUP_SPEED,        // faster balls
+    POWERUP_STICKY,       // ball sticks to paddle until space
+    POWERUP_PASS_THROUGH, // ball goes through breakable bricks
+    POWERUP_PADDLE_SIZE,  // wider paddle
+    POWERUP_MULTIBALL,    // extra balls, no timer
+    POWERUP_CHAOS,        // the bad ones: swirling edges,
+    POWERUP_CONFUSE,      // upside down & inverted
+    POWERUP_TYPES
+};
+
+/**
+ * Falling power-ups, stored as a structure of arrays with a fixed capacity.
+ * Live ones are [0, Count): spawning appends, removing moves the last one into
+ * the hole, so both are O(1) and nothing ever allocates. Update moves all of
+ * them and tests them against the paddle in one pass.
+ */
+class PowerUpPool
+{
+    public:
+        static const unsigned int CAPACITY = 64;
+
+        float X[CAPACITY], Y[CAPACITY]; // top left, in world space
+        unsigned char Type[CAPACITY];   // PowerUpType
+        unsigned int Count;
+
+        PowerUpPool();
+
+        bool Spawn(PowerUpType type, glm::vec2 position); // false (and nothing spawned) when full
+        // falls for dt, drops those below bottom, returns a bit per PowerUpType the paddle caught
+        unsigned int Update(float dt, float bottom, glm::vec2 paddleMin, glm::vec2 paddleMax);
+        void Clear();
+        void Snapshot(std::vector<BrickInstance> &instances) const; // replaces contents, drawn like bricks
+
+    private:
+        void remove(unsigned int i);
+};
+
+/**
+ * Timed effects, seconds left per PowerUpType (0: not active). Catching a
+ * power-up that is already active restarts its timer.
+ */
+struct PowerUpEffects
+{
+    float Remaining[POWERUP_TYPES];
+
+    PowerUpEffects();
+
+    bool Active(PowerUpType type) const { return this->Remaining[type] > 0.0f; }
+    bool Activate(PowerUpType type); // true if it wasn't active yet
+    unsigned int Update(float dt); // returns a bit per PowerUpType that ran out
+    void Clear();
+};
+
+// per-type spawn chances & durations, same order as PowerUpType
+extern const unsigned int POWERUP_CHANCE[POWERUP_TYPES]; // 1 in N per destroyed brick
+extern const float POWERUP_DURATION[POWERUP_TYPES];      // seconds, 0 for instant ones
+extern const glm::vec3 POWERUP_COLOR[POWERUP_TYPES];
+
+#endif
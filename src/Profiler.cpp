@@ -0,0 +1,173 @@
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// every ring ever registered, rings outlive their threads so late dumps still see them
+static std::mutex RingsMutex;
+static std::vector<ProfileRing*> Rings;
+
+// tick rate is calibrated against steady_clock between startup and each dump
+static const uint64_t StartTicks = Profiler::Now();
+static const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+static int ListenSocket = -1;
+static std::string SocketPath;
+static std::thread ServeThread;
+
+ProfileRing* Profiler::registerThread()
+{
+    ProfileRing *ring = new ProfileRing(); // zeroed
+    std::lock_guard<std::mutex> lock(RingsMutex);
+    ring->ThreadId = Rings.size() + 1;
+    Rings.push_back(ring);
+    return ring;
+}
+
+void Profiler::SetThreadName(const char *name)
+{
+    ThreadRing().ThreadName.store(name, std::memory_order_relaxed);
+}
+
+static void appendEvent(std::string &json, const char *name, unsigned int tid, double ts, double dur, uint32_t allocations)
+{
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"allocs\":%u}}", name, tid, ts, dur, allocations);
+    json += buffer;
+}
+
+/**
+ * Copies each ring and throws away zones the owner overwrote while copying.
+ */
+std::string Profiler::Dump()
+{
+    double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - StartTime).count();
+    uint64_t elapsedTicks = Profiler::Now() - StartTicks;
+    double ticksPerUs = elapsedUs > 0.0 ? elapsedTicks / elapsedUs : 1.0;
+
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"breakout\"}}";
+
+    std::lock_guard<std::mutex> lock(RingsMutex);
+    for (ProfileRing *ring : Rings)
+    {
+        const char *threadName = ring->ThreadName.load(std::memory_order_relaxed);
+        char buffer[128];
+        std::snprintf(buffer, sizeof(buffer), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                      ring->ThreadId, threadName != nullptr ? threadName : "thread");
+        json += buffer;
+
+        uint64_t head = ring->Head.load(std::memory_order_acquire);
+        uint64_t first = head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0;
+        struct Copy { const char *Name; uint64_t Begin, End; uint32_t Allocations; };
+        std::vector<Copy> copies;
+        copies.reserve(head - first);
+        for (uint64_t i = first; i < head; i++)
+        {
+            const ProfileEvent &event = ring->Events[i & (PROFILE_RING_SIZE - 1)];
+            copies.push_back(Copy{ event.Name.load(std::memory_order_relaxed), event.Begin.load(std::memory_order_relaxed), event.End.load(std::memory_order_relaxed), event.Allocations.load(std::memory_order_relaxed) });
+        }
+
+        // zones below newHead + 1 - PROFILE_RING_SIZE may have been rewritten during the copy,
+        // that includes the slot Record may still be writing zone newHead into, so it's dropped too
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t newHead = ring->Head.load(std::memory_order_relaxed);
+        uint64_t valid = newHead + 1 > PROFILE_RING_SIZE ? newHead + 1 - PROFILE_RING_SIZE : 0;
+        for (uint64_t i = std::max(first, valid); i < head; i++)
+        {
+            const Copy &copy = copies[i - first];
+            if (copy.Name == nullptr || copy.End < StartTicks)
+                continue;
+            appendEvent(json, copy.Name, ring->ThreadId, (copy.Begin - StartTicks) / ticksPerUs, (copy.End - copy.Begin) / ticksPerUs, copy.Allocations);
+        }
+    }
+
+    json += "\n]}\n";
+    return json;
+}
+
+bool Profiler::Dump(const char *file)
+{
+    std::string json = Dump();
+    FILE *out = std::fopen(file, "wb");
+    if (out == nullptr)
+    {
+        std::cout << "ERROR: could not write profile: " << file << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(json.data(), 1, json.size(), out) == json.size();
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok)
+        std::cout << "ERROR: could not write profile: " << file << std::endl;
+    return ok;
+}
+
+bool Profiler::Listen(const char *socketPath)
+{
+    sockaddr_un address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    if (std::strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        std::cout << "ERROR: profiler socket path too long: " << socketPath << std::endl;
+        return false;
+    }
+    std::strcpy(address.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath); // left over from a crashed run
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 4) != 0)
+    {
+        std::cout << "ERROR: could not open profiler socket: " << socketPath << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+
+    ListenSocket = fd;
+    SocketPath = socketPath;
+    ServeThread = std::thread(&Profiler::serve);
+    return true;
+}
+
+void Profiler::Close()
+{
+    if (ListenSocket < 0)
+        return;
+
+    shutdown(ListenSocket, SHUT_RDWR); // wakes accept()
+    ServeThread.join();
+    close(ListenSocket);
+    unlink(SocketPath.c_str());
+    ListenSocket = -1;
+}
+
+void Profiler::serve()
+{
+    int client;
+    while ((client = accept(ListenSocket, nullptr, nullptr)) >= 0)
+    {
+        std::string json = Dump();
+        size_t written = 0;
+        while (written < json.size())
+        {
+            ssize_t n = send(client, json.data() + written, json.size() - written, MSG_NOSIGNAL);
+            if (n <= 0)
+                break; // reader went away
+            written += n;
+        }
+        close(client);
+    }
+}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// Counters for the performance overlay, render thread only
+struct RenderStats
+{
+    static inline unsigned int DrawCalls = 0; // since Game::Render started the frame
+};
+
+#endif
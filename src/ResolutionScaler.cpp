@@ -0,0 +1,53 @@
+#include "ResolutionScaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+const float SMOOTHING = 0.1f; // weight of newest sample
+
+ResolutionScaler::ResolutionScaler(float budgetMs)
+    : budgetMs(budgetMs), scale(MAX_SCALE), pinned(false), smoothedMs(0.0f), cooldown(0)
+{
+}
+
+void ResolutionScaler::Pin(float scale)
+{
+    this->pinned = scale > 0.0f;
+    if (this->pinned)
+        this->scale = std::clamp(scale, MIN_SCALE, MAX_SCALE);
+    this->smoothedMs = 0.0f;
+    this->cooldown = 0;
+}
+
+float ResolutionScaler::Update(float gpuMs)
+{
+    this->smoothedMs = this->smoothedMs > 0.0f ? this->smoothedMs + SMOOTHING * (gpuMs - this->smoothedMs) : gpuMs;
+    if (this->pinned)
+        return this->scale;
+    if (this->cooldown > 0)
+    {
+        this->cooldown--;
+        return this->scale;
+    }
+
+    float scale = this->scale;
+    if (this->smoothedMs > DOWN_LOAD * this->budgetMs)
+    {
+        // aim for the middle of the band, at least one step down
+        float fit = this->scale * std::sqrt(0.5f * (DOWN_LOAD + UP_LOAD) * this->budgetMs / this->smoothedMs);
+        scale = std::min(std::floor(fit / STEP + 0.01f) * STEP, this->scale - STEP);
+    }
+    else if (this->smoothedMs < UP_LOAD * this->budgetMs)
+    {
+        scale = this->scale + STEP;
+    }
+    scale = std::clamp(std::round(scale / STEP) * STEP, MIN_SCALE, MAX_SCALE);
+
+    if (scale != this->scale)
+    {
+        this->scale = scale;
+        this->smoothedMs = 0.0f; // old samples were at the old scale
+        this->cooldown = COOLDOWN_FRAMES;
+    }
+    return this->scale;
+}
@@ -0,0 +1,45 @@
+#ifndef RESOLUTION_SCALER_H
+#define RESOLUTION_SCALER_H
+
+/**
+ * Picks the scene's render scale (fraction of the output resolution per axis)
+ * from measured GPU frame times, so the GPU part of a frame stays within the
+ * frame budget.
+ *
+ * GPU time is smoothed first. Above DOWN_LOAD of the budget the scale drops,
+ * straight to where the smoothed time should fit (cost goes with pixel count,
+ * scale squared). Below UP_LOAD it creeps back up one STEP at a time. The gap
+ * between the two, and COOLDOWN_FRAMES of no changes after each one, keep it
+ * from flipping back and forth. Scales are multiples of STEP, so the render
+ * target is only reallocated when the scale really moves.
+ *
+ * Pinning a scale turns all of this off.
+ */
+class ResolutionScaler
+{
+    public:
+        static constexpr float MIN_SCALE = 0.5f;
+        static constexpr float MAX_SCALE = 1.0f;
+        static constexpr float STEP = 0.05f;
+        static constexpr float DOWN_LOAD = 0.85f; // of budget
+        static constexpr float UP_LOAD = 0.6f;
+        static const unsigned int COOLDOWN_FRAMES = 30; // measured frames
+
+        explicit ResolutionScaler(float budgetMs); // GPU time per frame, e.g. the refresh period
+
+        void Pin(float scale); // fixed scale (clamped), 0 goes back to adjusting
+        bool Pinned() const { return this->pinned; }
+
+        float Update(float gpuMs); // one measured frame, returns scale to render at
+        float Scale() const { return this->scale; }
+        float SmoothedMs() const { return this->smoothedMs; }
+
+    private:
+        float budgetMs;
+        float scale;
+        bool pinned;
+        float smoothedMs; // 0: no sample since last change
+        unsigned int cooldown;
+};
+
+#endif
@@ -3,111 +3,373 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "ShaderCache.h"
 
 // Instantiate static variables
-std::map<std::string, Texture2D>    ResourceManager::Textures;
-std::map<std::string, Shader>       ResourceManager::Shaders;
+std::vector<Texture2D>  ResourceManager::Textures;
+std::vector<Shader>     ResourceManager::Shaders;
+std::unordered_map<std::string, unsigned int> ResourceManager::textureIndices;
+std::unordered_map<std::string, unsigned int> ResourceManager::shaderIndices;
+std::vector<ResourceManager::ShaderSource>  ResourceManager::shaderSources;
+std::vector<ResourceManager::TextureSource> ResourceManager::textureSources;
+std::vector<ResourceManager::PendingTexture> ResourceManager::pendingTextures;
+AssetPack ResourceManager::Pack;
 
-Shader ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
+ShaderHandle ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string &name)
 {
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return Shaders[name];
+    Shader shader;
+    loadShaderFromFile(shader, vShaderFile, fShaderFile, gShaderFile);
+
+    ShaderSource source = { vShaderFile, fShaderFile, gShaderFile != nullptr ? gShaderFile : "" };
+
+    auto found = shaderIndices.find(name);
+    if (found != shaderIndices.end())
+    {
+        Shaders[found->second] = std::move(shader); // old program is deleted
+        shaderSources[found->second] = source;
+        return ShaderHandle{ found->second };
+    }
+
+    Shaders.push_back(std::move(shader));
+    shaderSources.push_back(source);
+    shaderIndices[name] = Shaders.size() - 1;
+    return ShaderHandle{ static_cast<unsigned int>(Shaders.size() - 1) };
+}
+
+ShaderHandle ResourceManager::FindShader(const std::string &name)
+{
+    auto found = shaderIndices.find(name);
+    if (found == shaderIndices.end())
+        throw std::runtime_error("ResourceManager: unknown shader: " + name);
+    return ShaderHandle{ found->second };
+}
+
+Shader& ResourceManager::GetShader(ShaderHandle handle)
+{
+    return Shaders[handle.Index];
+}
+
+Shader& ResourceManager::GetShader(const std::string &name)
+{
+    return Shaders[FindShader(name).Index];
+}
+
+TextureHandle ResourceManager::LoadTexture(const char *file, bool alpha, const std::string &name)
+{
+    DecodedImage image;
+    if (findPackedTexture(file, alpha, image))
+        return storeTexture(name, file, alpha, image);
+
+    return storeTexture(name, file, alpha, TextureCache::Decode(file));
+}
+
+TextureHandle ResourceManager::FindTexture(const std::string &name)
+{
+    auto found = textureIndices.find(name);
+    if (found == textureIndices.end())
+        throw std::runtime_error("ResourceManager: unknown texture: " + name);
+    return TextureHandle{ found->second };
+}
+
+const Texture2D& ResourceManager::GetTexture(TextureHandle handle)
+{
+    return Textures[handle.Index];
+}
+
+const Texture2D& ResourceManager::GetTexture(const std::string &name)
+{
+    return Textures[FindTexture(name).Index];
+}
+
+bool ResourceManager::ReloadShaderFile(const std::string &file)
+{
+    bool reloaded = false;
+    for (unsigned int i = 0; i < Shaders.size(); i++)
+    {
+        ShaderSource &source = shaderSources[i];
+        if (source.Vertex != file && source.Fragment != file && source.Geometry != file)
+            continue;
+
+        Shader shader;
+        bool compiled = loadShaderFromFile(shader, source.Vertex.c_str(), source.Fragment.c_str(), source.Geometry.empty() ? nullptr : source.Geometry.c_str(), false);
+        if (!compiled) // keep old program running (failed one is deleted with shader)
+        {
+            std::cout << "ERROR: reload of " << file << " failed, keeping old shader" << std::endl;
+            continue;
+        }
+
+        Shaders[i] = std::move(shader);
+        reloaded = true;
+    }
+    return reloaded;
+}
+
+bool ResourceManager::ReloadTextureFile(const std::string &file)
+{
+    bool reloading = false;
+    for (auto &entry : textureIndices)
+    {
+        TextureSource &source = textureSources[entry.second];
+        if (source.File == file)
+        {
+            // new pixels go into existing texture object, so TextureViews of it see them too
+            decodeTextureAsync(source.File.c_str(), source.Alpha, entry.first);
+            reloading = true;
+        }
+    }
+    return reloading;
+}
+
+/**
+ * Uploads image into texture with given name, creating it if it doesn't exist yet.
+ * An existing texture is left as it is if image failed to decode.
+ */
+TextureHandle ResourceManager::storeTexture(const std::string &name, const std::string &file, bool alpha, DecodedImage image)
+{
+    auto found = textureIndices.find(name);
+    if (found != textureIndices.end())
+    {
+        if (image.Data == nullptr) // e.g. half saved file, keep old texture in use
+        {
+            std::cout << "ERROR: reload of " << file << " failed, keeping old texture" << std::endl;
+            TextureCache::Free(image);
+            return TextureHandle{ found->second };
+        }
+        uploadTexture(image, alpha, file.c_str(), Textures[found->second]);
+        textureSources[found->second] = TextureSource{ file, alpha };
+        return TextureHandle{ found->second };
+    }
+
+    Textures.emplace_back();
+    uploadTexture(image, alpha, file.c_str(), Textures.back());
+    textureSources.push_back(TextureSource{ file, alpha });
+    textureIndices[name] = Textures.size() - 1;
+    return TextureHandle{ static_cast<unsigned int>(Textures.size() - 1) };
+}
+
+std::shared_future<TextureHandle> ResourceManager::LoadTextureAsync(const char *file, bool alpha, const std::string &name)
+{
+    // already decoded in asset pack, nothing to wait for
+    DecodedImage image;
+    if (findPackedTexture(file, alpha, image))
+    {
+        std::promise<TextureHandle> uploaded;
+        uploaded.set_value(storeTexture(name, file, alpha, image));
+        return uploaded.get_future().share();
+    }
+
+    return decodeTextureAsync(file, alpha, name);
+}
+
+std::shared_future<TextureHandle> ResourceManager::decodeTextureAsync(const char *file, bool alpha, const std::string &name)
+{
+    PendingTexture pending;
+    pending.Name = name;
+    pending.File = file;
+    pending.Alpha = alpha;
+    pending.Decode = std::async(std::launch::async, [file = pending.File]() { return TextureCache::Decode(file.c_str()); });
+    std::shared_future<TextureHandle> uploaded = pending.Uploaded.get_future().share();
+
+    pendingTextures.push_back(std::move(pending));
+    return uploaded;
+}
+
+/**
+ * Points image at pixels in the asset pack. Returns false if pack doesn't have file
+ * (or has it with other channels than alpha asks for, then it's loaded from disk).
+ */
+bool ResourceManager::findPackedTexture(const char *file, bool alpha, DecodedImage &image)
+{
+    const PackEntry *entry = Pack.Find(file, PACK_TEXTURE);
+    if (entry == nullptr)
+        return false;
+    if (entry->Channels != (alpha ? 4u : 3u))
+    {
+        std::cout << "ERROR: packed " << file << " has " << entry->Channels << " channels, expected " << (alpha ? 4 : 3) << std::endl;
+        return false;
+    }
+
+    image.Width = entry->Width;
+    image.Height = entry->Height;
+    image.Channels = entry->Channels;
+    image.Data = const_cast<unsigned char*>(Pack.Data(*entry));
+    image.Mapping = nullptr;
+    image.MappingSize = 0;
+    image.Borrowed = true;
+    return true;
+}
+
+void ResourceManager::UploadPendingTextures()
+{
+    for (unsigned int i = 0; i < pendingTextures.size(); )
+    {
+        if (uploadPendingTexture(pendingTextures[i], false))
+            pendingTextures.erase(pendingTextures.begin() + i);
+        else
+            i++;
+    }
 }
 
-Shader ResourceManager::GetShader(std::string name)
+void ResourceManager::WaitForTextures()
 {
-    return Shaders[name];
+    // upload in whatever order decodes finish, so big images don't hold up small ones
+    while (!pendingTextures.empty())
+    {
+        UploadPendingTextures();
+
+        if (!pendingTextures.empty())
+        {
+            if (uploadPendingTexture(pendingTextures[0], true))
+                pendingTextures.erase(pendingTextures.begin());
+        }
+    }
 }
 
-Texture2D ResourceManager::LoadTexture(const char *file, bool alpha, std::string name)
+/**
+ * Uploads texture if its decode is done (or, if block is true, once it is done).
+ * Returns true if texture was uploaded.
+ */
+bool ResourceManager::uploadPendingTexture(PendingTexture &pending, bool block)
 {
-    Textures[name] = loadTextureFromFile(file, alpha);
-    return Textures[name];
+    if (!block && pending.Decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+
+    pending.Uploaded.set_value(storeTexture(pending.Name, pending.File, pending.Alpha, pending.Decode.get()));
+    return true;
 }
 
-Texture2D ResourceManager::GetTexture(std::string name)
+bool ResourceManager::OpenPack(const char *file)
 {
-    return Textures[name];
+    return Pack.Open(file);
 }
 
 void ResourceManager::Clear()
 {
-    // (properly) delete all shaders	
-    for (auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
-    // (properly) delete all textures
-    for (auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+    // shaders and textures delete their GL objects
+    Shaders.clear();
+    Textures.clear();
+    shaderSources.clear();
+    textureSources.clear();
+    shaderIndices.clear();
+    textureIndices.clear();
+    Pack.Close();
 }
 
-Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
+/**
+ * Returns false if shader failed to compile or link (shader still owns the broken program).
+ */
+bool ResourceManager::loadShaderFromFile(Shader &shader, const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, bool usePack)
 {
-    // 1. retrieve the vertex/fragment source code from filePath
+    const char *vShaderCode = nullptr;
+    const char *fShaderCode = nullptr;
+    const char *gShaderCode = nullptr;
+
+    // 1. sources straight from the asset pack, no copies
+    const PackEntry *vEntry = usePack ? Pack.Find(vShaderFile, PACK_SHADER) : nullptr;
+    const PackEntry *fEntry = usePack ? Pack.Find(fShaderFile, PACK_SHADER) : nullptr;
+    const PackEntry *gEntry = usePack && gShaderFile != nullptr ? Pack.Find(gShaderFile, PACK_SHADER) : nullptr;
+
+    // 1. or retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
     std::string fragmentCode;
     std::string geometryCode;
-    try
+    if (vEntry != nullptr && fEntry != nullptr && (gShaderFile == nullptr || gEntry != nullptr))
+    {
+        vShaderCode = reinterpret_cast<const char*>(Pack.Data(*vEntry));
+        fShaderCode = reinterpret_cast<const char*>(Pack.Data(*fEntry));
+        gShaderCode = gEntry != nullptr ? reinterpret_cast<const char*>(Pack.Data(*gEntry)) : nullptr;
+    }
+    else
+    {
+        try
+        {
+            // open files
+            std::ifstream vertexShaderFile(vShaderFile);
+            std::ifstream fragmentShaderFile(fShaderFile);
+            std::stringstream vShaderStream, fShaderStream;
+            // read file's buffer contents into streams
+            vShaderStream << vertexShaderFile.rdbuf();
+            fShaderStream << fragmentShaderFile.rdbuf();
+            // close file handlers
+            vertexShaderFile.close();
+            fragmentShaderFile.close();
+            // convert stream into string
+            vertexCode = vShaderStream.str();
+            fragmentCode = fShaderStream.str();
+            // if geometry shader path is present, also load a geometry shader
+            if (gShaderFile != nullptr)
+            {
+                std::ifstream geometryShaderFile(gShaderFile);
+                std::stringstream gShaderStream;
+                gShaderStream << geometryShaderFile.rdbuf();
+                geometryShaderFile.close();
+                geometryCode = gShaderStream.str();
+            }
+        }
+        catch (std::exception e)
+        {
+            std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
+        }
+        vShaderCode = vertexCode.c_str();
+        fShaderCode = fragmentCode.c_str();
+        gShaderCode = gShaderFile != nullptr ? geometryCode.c_str() : nullptr;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    // 2. try program binary cached by a previous run
+    bool useCache = ShaderCache::Enabled && ShaderCache::Supported();
+    uint64_t key = 0;
+    if (useCache)
     {
-        // open files
-        std::ifstream vertexShaderFile(vShaderFile);
-        std::ifstream fragmentShaderFile(fShaderFile);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vertexShaderFile.rdbuf();
-        fShaderStream << fragmentShaderFile.rdbuf();
-        // close file handlers
-        vertexShaderFile.close();
-        fragmentShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-        // if geometry shader path is present, also load a geometry shader
-        if (gShaderFile != nullptr)
+        key = ShaderCache::Key(vShaderCode, fShaderCode, gShaderCode);
+        float compileMs;
+        if (ShaderCache::Load(vShaderFile, fShaderFile, gShaderFile, key, shader, compileMs))
         {
-            std::ifstream geometryShaderFile(gShaderFile);
-            std::stringstream gShaderStream;
-            gShaderStream << geometryShaderFile.rdbuf();
-            geometryShaderFile.close();
-            geometryCode = gShaderStream.str();
+            std::chrono::duration<float, std::milli> loadMs = std::chrono::steady_clock::now() - start;
+            std::cout << "SHADER: " << vShaderFile << " loaded from cache in " << loadMs.count()
+                << " ms (saved " << compileMs - loadMs.count() << " ms)" << std::endl;
+            return true;
         }
     }
-    catch (std::exception e)
+
+    // 3. otherwise create shader object from source code
+    bool compiled = shader.Compile(vShaderCode, fShaderCode, gShaderCode);
+
+    if (useCache && compiled)
     {
-        std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
+        std::chrono::duration<float, std::milli> compileMs = std::chrono::steady_clock::now() - start;
+        ShaderCache::Store(vShaderFile, fShaderFile, gShaderFile, key, shader, compileMs.count());
     }
-    const char *vShaderCode = vertexCode.c_str();
-    const char *fShaderCode = fragmentCode.c_str();
-    const char *gShaderCode = geometryCode.c_str();
-    // 2. now create shader object from source code
-    Shader shader;
-    shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
-    return shader;
+    return compiled;
 }
 
-Texture2D ResourceManager::loadTextureFromFile(const char *file, bool alpha)
+/**
+ * Must be called on the thread that owns the OpenGL context. Frees image data.
+ */
+void ResourceManager::uploadTexture(DecodedImage image, bool alpha, const char *file, Texture2D &texture)
 {
-    // create texture object
-    Texture2D texture;
     if (alpha)
     {
         texture.Internal_Format = GL_RGBA;
         texture.Image_Format = GL_RGBA;
     }
-    // load image
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
+    else
+    {
+        texture.Internal_Format = GL_RGB;
+        texture.Image_Format = GL_RGB;
+    }
 
-    if (data == nullptr)
+    if (image.Data == nullptr)
     {
         std::cout << "ERROR: failed to load image: " << file << std::endl;
     }
 
     // now generate texture
-    texture.Generate(width, height, data);
-    // and finally free image data
-    stbi_image_free(data);
-    return texture;
-}
\ No newline at end of file
+    texture.Generate(image.Width, image.Height, image.Data);
+    // and finally free image data (or unmap cache file)
+    TextureCache::Free(image);
+}
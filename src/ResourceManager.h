@@ -1,26 +1,67 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
-#include <map>
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <future>
 
 #include <glad/glad.h>
 
 #include "Texture.h"
 #include "Shader.h"
+#include "TextureCache.h"
+#include "AssetPack.h"
 
-// Singleton
+// Index into ResourceManager's texture array, handed out at load time
+struct TextureHandle
+{
+    unsigned int Index;
+};
+
+// Index into ResourceManager's shader array, handed out at load time
+struct ShaderHandle
+{
+    unsigned int Index;
+};
+
+/**
+ * Singleton
+ *
+ * Resources live in dense arrays and are accessed through handles. Names are only
+ * looked up when loading or when asking for a handle, so hot paths should keep the
+ * handle around. Looking up an unknown name throws std::runtime_error.
+ */
 class ResourceManager
 {
     public:
-        static std::map<std::string, Shader> Shaders;
-        static std::map<std::string, Texture2D> Textures;
+        static std::vector<Shader> Shaders;
+        static std::vector<Texture2D> Textures;
+
+        // when open, assets are served from the pack and only missing ones come from disk
+        static AssetPack Pack;
+        static bool OpenPack(const char *file);
 
-        static Shader LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
-        static Shader GetShader(std::string name);
+        // loading an existing name replaces the resource and keeps its handle
+        static ShaderHandle LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string &name);
+        static ShaderHandle FindShader(const std::string &name);
+        static Shader& GetShader(ShaderHandle handle);
+        static Shader& GetShader(const std::string &name);
 
-        static Texture2D LoadTexture(const char *file, bool alpha, std::string name);
-        static Texture2D GetTexture(std::string name);
+        static TextureHandle LoadTexture(const char *file, bool alpha, const std::string &name);
+        static TextureHandle FindTexture(const std::string &name);
+        static const Texture2D& GetTexture(TextureHandle handle);
+        static const Texture2D& GetTexture(const std::string &name);
+
+        // hot reload: reload every resource loaded from file (always from disk), return false if there is none
+        static bool ReloadShaderFile(const std::string &file); // on compile error old program is kept
+        static bool ReloadTextureFile(const std::string &file); // decoded async, uploaded by UploadPendingTextures
+
+        // Decodes image on a worker thread. The upload to OpenGL happens on the context
+        // thread in UploadPendingTextures/WaitForTextures, which is when the future becomes ready.
+        static std::shared_future<TextureHandle> LoadTextureAsync(const char *file, bool alpha, const std::string &name);
+        static void UploadPendingTextures(); // uploads finished decodes, does not block
+        static void WaitForTextures();       // uploads every pending texture as its decode finishes
 
         // De-allocates resources
         static void Clear();
@@ -28,8 +69,41 @@ class ResourceManager
     private:
         ResourceManager();
         
-        static Shader loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr);
-        static Texture2D loadTextureFromFile(const char *file, bool alpha);
+        static bool loadShaderFromFile(Shader &shader, const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr, bool usePack = true);
+
+        // texture loading is split in two so decoding can happen off the context thread
+        static void uploadTexture(DecodedImage image, bool alpha, const char *file, Texture2D &texture);
+        static std::shared_future<TextureHandle> decodeTextureAsync(const char *file, bool alpha, const std::string &name);
+        static bool findPackedTexture(const char *file, bool alpha, DecodedImage &image);
+
+        struct PendingTexture
+        {
+            std::string Name;
+            std::string File;
+            bool Alpha;
+            std::future<DecodedImage> Decode;
+            std::promise<TextureHandle> Uploaded;
+        };
+        static std::vector<PendingTexture> pendingTextures;
+        static bool uploadPendingTexture(PendingTexture &pending, bool block);
+
+        // names are interned once, at load time
+        static std::unordered_map<std::string, unsigned int> shaderIndices;
+        static std::unordered_map<std::string, unsigned int> textureIndices;
+        static TextureHandle storeTexture(const std::string &name, const std::string &file, bool alpha, DecodedImage image);
+
+        // where resources came from, same index as Shaders/Textures
+        struct ShaderSource
+        {
+            std::string Vertex, Fragment, Geometry; // Geometry empty if none
+        };
+        struct TextureSource
+        {
+            std::string File;
+            bool Alpha;
+        };
+        static std::vector<ShaderSource> shaderSources;
+        static std::vector<TextureSource> textureSources;
 };
 
 #endif
\ No newline at end of file
@@ -8,25 +8,26 @@ Shader::Shader()
 
 Shader& Shader::Use()
 {
-    glUseProgram(this->ID);
+    glUseProgram(this->ID.Get());
     return *this;
 }
 
-void Shader::Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource)
+bool Shader::Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource)
 {
     unsigned int sVertex, sFragment, gShader;
+    bool success = true;
 
     // Compile vertex shader
     sVertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(sVertex, 1, &vertexSource, NULL);
     glCompileShader(sVertex);
-    checkCompileErrors(sVertex, "VERTEX");
+    success = checkCompileErrors(sVertex, "VERTEX") && success;
 
     // Compile fragment shader
     sFragment = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(sFragment, 1, &fragmentSource, NULL);
     glCompileShader(sFragment);
-    checkCompileErrors(sFragment, "FRAGMENT");
+    success = checkCompileErrors(sFragment, "FRAGMENT") && success;
 
     if (geometrySource != nullptr)
     {
@@ -34,19 +35,23 @@ void Shader::Compile(const char *vertexSource, const char *fragmentSource, const
         gShader = glCreateShader(GL_GEOMETRY_SHADER);
         glShaderSource(gShader, 1, &geometrySource, NULL);
         glCompileShader(gShader);
-        checkCompileErrors(gShader, "GEOMETRY");
+        success = checkCompileErrors(gShader, "GEOMETRY") && success;
     }
 
     // Create shader program (link previous shaders)
-    this->ID = glCreateProgram();
-    glAttachShader(this->ID, sVertex);
-    glAttachShader(this->ID, sFragment);
+    this->ID.Reset(glCreateProgram()); // recompiling replaces (and deletes) old program
+    glAttachShader(this->ID.Get(), sVertex);
+    glAttachShader(this->ID.Get(), sFragment);
     if (geometrySource != nullptr)
     {
-        glAttachShader(this->ID, gShader);
+        glAttachShader(this->ID.Get(), gShader);
     }
-    glLinkProgram(this->ID);
-    checkCompileErrors(this->ID, "PROGRAM");
+    if (glProgramParameteri != nullptr) // so program can be stored in ShaderCache
+    {
+        glProgramParameteri(this->ID.Get(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(this->ID.Get());
+    success = checkCompileErrors(this->ID.Get(), "PROGRAM") && success;
 
     // Shaders on longer needed (delete them)
     glDeleteShader(sVertex);
@@ -55,75 +60,77 @@ void Shader::Compile(const char *vertexSource, const char *fragmentSource, const
     {
         glDeleteShader(gShader);
     }
+
+    return success;
 }
 
 void Shader::SetFloat(const char *name, float value, bool useShader)
 {
     if (useShader)
     {
-        glUseProgram(this->ID);
+        glUseProgram(this->ID.Get());
     }
 
-    glUniform1f(glGetUniformLocation(this->ID, name), value);
+    glUniform1f(glGetUniformLocation(this->ID.Get(), name), value);
 }
 
 void Shader::SetInteger(const char *name, int value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform1i(glGetUniformLocation(this->ID, name), value);
+    glUniform1i(glGetUniformLocation(this->ID.Get(), name), value);
 }
 
 void Shader::SetVector2f(const char *name, float x, float y, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+    glUniform2f(glGetUniformLocation(this->ID.Get(), name), x, y);
 }
 
 void Shader::SetVector2f(const char *name, const glm::vec2 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+    glUniform2f(glGetUniformLocation(this->ID.Get(), name), value.x, value.y);
 }
 
 void Shader::SetVector3f(const char *name, float x, float y, float z, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+    glUniform3f(glGetUniformLocation(this->ID.Get(), name), x, y, z);
 }
 
 void Shader::SetVector3f(const char *name, const glm::vec3 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+    glUniform3f(glGetUniformLocation(this->ID.Get(), name), value.x, value.y, value.z);
 }
 
 void Shader::SetVector4f(const char *name, float x, float y, float z, float w, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+    glUniform4f(glGetUniformLocation(this->ID.Get(), name), x, y, z, w);
 }
 
 void Shader::SetVector4f(const char *name, const glm::vec4 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+    glUniform4f(glGetUniformLocation(this->ID.Get(), name), value.x, value.y, value.z, value.w);
 }
 
 void Shader::SetMatrix4(const char *name, const glm::mat4 &matrix, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
+    glUniformMatrix4fv(glGetUniformLocation(this->ID.Get(), name), 1, false, glm::value_ptr(matrix));
 }
 
-void Shader::checkCompileErrors(unsigned int object, std::string type)
+bool Shader::checkCompileErrors(unsigned int object, std::string type)
 {
     int success;
     char infoLog[1024];
@@ -149,4 +156,6 @@ void Shader::checkCompileErrors(unsigned int object, std::string type)
                 << std::endl;
         }
     }
-}
\ No newline at end of file
+
+    return success;
+}
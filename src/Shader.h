@@ -7,15 +7,18 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "GLObject.h"
+
+// Owns its program, so it can be moved but not copied
 class Shader
 {
     public:
-        unsigned int ID;
+        GLProgram ID;
 
         Shader();
 
         Shader& Use();
-        void    Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr);
+        bool    Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr); // false if compiling or linking failed
 
         // Set uniforms 
         void SetFloat    (const char *name, float value, bool useShader = false);
@@ -29,7 +32,7 @@ class Shader
         void SetMatrix4  (const char *name, const glm::mat4& matrix, bool useShader = false);
 
     private:
-        void checkCompileErrors(unsigned int object, std::string type); // prints error if errors
+        bool checkCompileErrors(unsigned int object, std::string type); // prints error if errors, returns false then
 };
 
 #endif
\ No newline at end of file
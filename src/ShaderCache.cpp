@@ -0,0 +1,157 @@
+#include "ShaderCache.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <utility>
+
+#include <sys/stat.h>
+
+static_assert(sizeof(ShaderCacheHeader) == 32, "unexpected shader cache header size");
+
+const char SHADER_CACHE_MAGIC[4] = { 'B', 'P', 'R', 'G' };
+const uint32_t SHADER_CACHE_VERSION = 1;
+
+std::string ShaderCache::CacheDir = "cache/";
+bool        ShaderCache::Enabled = true;
+
+static void hashBytes(uint64_t &hash, const char *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    // separator, so "ab" + "c" and "a" + "bc" hash differently
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+}
+
+static void hashGLString(uint64_t &hash, GLenum name)
+{
+    const char *value = reinterpret_cast<const char*>(glGetString(name));
+    if (value != nullptr)
+        hashBytes(hash, value, std::strlen(value));
+}
+
+bool ShaderCache::Supported()
+{
+    if (glGetProgramBinary == nullptr || glProgramBinary == nullptr || glProgramParameteri == nullptr)
+        return false;
+
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+/**
+ * FNV-1a of sources plus GL vendor, renderer and version (binaries are driver specific).
+ */
+uint64_t ShaderCache::Key(const char *vertexCode, const char *fragmentCode, const char *geometryCode)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hashGLString(hash, GL_VENDOR);
+    hashGLString(hash, GL_RENDERER);
+    hashGLString(hash, GL_VERSION);
+    hashBytes(hash, vertexCode, std::strlen(vertexCode));
+    hashBytes(hash, fragmentCode, std::strlen(fragmentCode));
+    if (geometryCode != nullptr)
+        hashBytes(hash, geometryCode, std::strlen(geometryCode));
+    return hash;
+}
+
+bool ShaderCache::Load(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, uint64_t key, Shader &shader, float &compileMs)
+{
+    std::string path = CachePath(vShaderFile, fShaderFile, gShaderFile);
+    FILE *in = std::fopen(path.c_str(), "rb");
+    if (in == nullptr) // not cached yet
+        return false;
+
+    ShaderCacheHeader header;
+    std::vector<char> binary;
+    bool ok = std::fread(&header, sizeof(header), 1, in) == 1
+        && std::memcmp(header.Magic, SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC)) == 0
+        && header.Version == SHADER_CACHE_VERSION
+        && header.Key == key;
+    if (ok)
+    {
+        binary.resize(header.BinaryLength);
+        ok = std::fread(binary.data(), 1, binary.size(), in) == binary.size();
+    }
+    std::fclose(in);
+
+    if (!ok) // stale or broken, will be overwritten by Store()
+        return false;
+
+    GLProgram program(glCreateProgram());
+    glProgramBinary(program.Get(), header.BinaryFormat, binary.data(), header.BinaryLength);
+
+    int success;
+    glGetProgramiv(program.Get(), GL_LINK_STATUS, &success);
+    if (!success) // driver rejected binary (e.g. after driver update)
+        return false;
+
+    shader.ID = std::move(program);
+    compileMs = header.CompileMs;
+    return true;
+}
+
+void ShaderCache::Store(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, uint64_t key, const Shader &shader, float compileMs)
+{
+    int length = 0;
+    glGetProgramiv(shader.ID.Get(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    ShaderCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(shader.ID.Get(), length, nullptr, &format, binary.data());
+
+    std::memcpy(header.Magic, SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC));
+    header.Version = SHADER_CACHE_VERSION;
+    header.Key = key;
+    header.BinaryFormat = format;
+    header.BinaryLength = length;
+    header.CompileMs = compileMs;
+
+    mkdir(CacheDir.c_str(), 0755); // fails harmlessly if it already exists
+
+    std::string path = CachePath(vShaderFile, fShaderFile, gShaderFile);
+    std::string tmpPath = path + ".tmp";
+    FILE *out = std::fopen(tmpPath.c_str(), "wb");
+    if (out == nullptr)
+    {
+        std::cout << "ERROR: could not write shader cache: " << tmpPath << std::endl;
+        return;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1
+        && std::fwrite(binary.data(), 1, binary.size(), out) == binary.size();
+    ok = std::fclose(out) == 0 && ok;
+
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::cout << "ERROR: could not write shader cache: " << path << std::endl;
+        std::remove(tmpPath.c_str());
+    }
+}
+
+/**
+ * shaders/sprite.vs, shaders/sprite.fs --> cache/shaders_sprite.vs+shaders_sprite.fs.prog
+ * (+ geometry shader file, if any), so programs sharing a file get entries of their own.
+ */
+std::string ShaderCache::CachePath(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
+{
+    std::string name = std::string(vShaderFile) + "+" + fShaderFile;
+    if (gShaderFile != nullptr)
+        name = name + "+" + gShaderFile;
+    for (char &c : name)
+    {
+        if (c == '/' || c == '\\')
+            c = '_';
+    }
+    return CacheDir + name + ".prog";
+}
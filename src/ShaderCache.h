@@ -0,0 +1,49 @@
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include "Shader.h"
+
+// Header at the start of every program binary cache file, binary follows right after it
+struct ShaderCacheHeader
+{
+    char Magic[4];          // "BPRG"
+    uint32_t Version;
+    uint64_t Key;           // see ShaderCache::Key()
+    uint32_t BinaryFormat;  // as returned by glGetProgramBinary
+    uint32_t BinaryLength;
+    float CompileMs;        // how long compiling & linking from source took
+    uint32_t Reserved;
+};
+
+/**
+ * On-disk cache of linked shader programs (glGetProgramBinary/glProgramBinary).
+ *
+ * A cache entry is only used if its key, a hash of the shader sources and the GL
+ * vendor, renderer and version strings, matches. If the driver still rejects the
+ * binary, the caller compiles from source and overwrites the entry.
+ * Must be used on the thread that owns the OpenGL context.
+ */
+class ShaderCache
+{
+    public:
+        static std::string CacheDir;
+        static bool Enabled;
+
+        static bool Supported(); // driver can hand out program binaries
+        static uint64_t Key(const char *vertexCode, const char *fragmentCode, const char *geometryCode); // geometryCode may be nullptr
+
+        // entries are per set of source files, gShaderFile may be nullptr
+        // returns true and sets shader.ID (replacing its program) if a valid binary was found
+        static bool Load(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, uint64_t key, Shader &shader, float &compileMs);
+        static void Store(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, uint64_t key, const Shader &shader, float compileMs);
+
+        static std::string CachePath(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile);
+
+    private:
+        ShaderCache();
+};
+
+#endif
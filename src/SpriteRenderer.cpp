@@ -1,21 +1,19 @@
 #include "SpriteRenderer.h"
+#include "Profiler.h"
+#include "RenderStats.h"
 
-SpriteRenderer::SpriteRenderer(const Shader &shader)
+SpriteRenderer::SpriteRenderer(ShaderHandle shader)
 {
     this->shader = shader;
     this->initRenderData();
 }
 
-SpriteRenderer::~SpriteRenderer()
-{
-    glDeleteVertexArrays(1, &this->quadVAO);
-    // what about deleting vertex buffer?
-}
-
-void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+void SpriteRenderer::DrawSprite(TextureView texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
 {
+    PROFILE_ZONE("SpriteRenderer::DrawSprite");
     // prepare transformations
-    this->shader.Use();
+    Shader &shader = ResourceManager::GetShader(this->shader);
+    shader.Use();
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(position, 0.0f));  
 
@@ -25,21 +23,21 @@ void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::vec2 position, gl
 
     model = glm::scale(model, glm::vec3(size, 1.0f)); 
   
-    this->shader.SetMatrix4("model", model);
-    this->shader.SetVector3f("spriteColor", color);
+    shader.SetMatrix4("model", model);
+    shader.SetVector3f("spriteColor", color);
   
     glActiveTexture(GL_TEXTURE0);
     texture.Bind();
 
-    glBindVertexArray(this->quadVAO);
+    glBindVertexArray(this->quadVAO.Get());
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderStats::DrawCalls++;
     glBindVertexArray(0);
 }
 
 void SpriteRenderer::initRenderData()
 {
-    // configure VAO/VBO
-    unsigned int VBO;
+    // configure VAO/VBO (owned, deleted with renderer)
     float vertices[] = { 
         // pos      // tex
         0.0f, 1.0f, 0.0f, 1.0f,
@@ -51,13 +49,16 @@ void SpriteRenderer::initRenderData()
         1.0f, 0.0f, 1.0f, 0.0f
     };
 
-    glGenVertexArrays(1, &this->quadVAO);
+    unsigned int VAO, VBO;
+    glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    this->quadVAO.Reset(VAO);
+    this->quadVBO.Reset(VBO);
     
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO.Get());
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(this->quadVAO);
+    glBindVertexArray(this->quadVAO.Get());
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);  
@@ -3,6 +3,8 @@
 
 #include "Shader.h"
 #include "Texture.h"
+#include "GLObject.h"
+#include "ResourceManager.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -11,14 +13,14 @@
 class SpriteRenderer
 {
     public:
-        SpriteRenderer(const Shader &shader);
-        ~SpriteRenderer();
+        SpriteRenderer(ShaderHandle shader);
 
-        void DrawSprite(const Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f,10.0f), float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+        void DrawSprite(TextureView texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f,10.0f), float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
 
     private:
-        Shader shader;
-        unsigned int quadVAO;
+        ShaderHandle shader; // handle, so renderer picks up reloaded shaders
+        GLVertexArray quadVAO;
+        GLBuffer quadVBO;
 
         void initRenderData();
 };
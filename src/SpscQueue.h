@@ -0,0 +1,54 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Lock-free bounded queue for exactly one producer thread and one consumer thread.
+ * CAPACITY must be a power of two. Push fails (instead of waiting) when full.
+ */
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        SpscQueue() : head(0), tail(0) { }
+
+        // producer side
+        bool Push(const T &value)
+        {
+            size_t tail = this->tail.load(std::memory_order_relaxed);
+            if (tail - this->head.load(std::memory_order_acquire) == CAPACITY)
+                return false;
+
+            this->slots[tail & (CAPACITY - 1)] = value;
+            this->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer side: oldest element or nullptr if empty, stays valid until Pop
+        const T* Front() const
+        {
+            size_t head = this->head.load(std::memory_order_relaxed);
+            if (head == this->tail.load(std::memory_order_acquire))
+                return nullptr;
+            return &this->slots[head & (CAPACITY - 1)];
+        }
+
+        void Pop()
+        {
+            this->head.store(this->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+    private:
+        T slots[CAPACITY];
+        alignas(64) std::atomic<size_t> head; // next to read, written by consumer
+        alignas(64) std::atomic<size_t> tail; // next to write, written by producer
+
+        SpscQueue(const SpscQueue&);
+        SpscQueue& operator=(const SpscQueue&);
+};
+
+#endif
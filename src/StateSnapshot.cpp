@@ -0,0 +1,399 @@
+#include "StateSnapshot.h"
+#include "GameLevel.h"
+#include "LevelFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(SimState) % sizeof(uint64_t) == 0, "brick bits after SimState must stay 8 byte aligned");
+
+BrickBits::BrickBits()
+    : Words(), generation(0), chunkVersions()
+{
+}
+
+void BrickBits::Update(const GameLevel &level)
+{
+    if (level.Generation != this->generation || this->Words.size() != WordCount(level.Bricks.size()) || this->chunkVersions.size() != level.Chunks.size())
+    {
+        this->generation = level.Generation;
+        this->Words.assign(WordCount(level.Bricks.size()), 0);
+        this->chunkVersions.assign(level.Chunks.size(), 0);
+        for (unsigned int c = 0; c < level.Chunks.size(); c++)
+            this->updateChunk(level, c);
+        return;
+    }
+
+    for (unsigned int c = 0; c < level.Chunks.size(); c++)
+    {
+        if (level.Chunks[c].Version != this->chunkVersions[c])
+            this->updateChunk(level, c);
+    }
+}
+
+void BrickBits::updateChunk(const GameLevel &level, unsigned int chunk)
+{
+    const LevelChunk &range = level.Chunks[chunk];
+    for (unsigned int i = range.First; i < range.First + range.Count; i++)
+    {
+        uint64_t bit = uint64_t(1) << (i % 64);
+        if (level.Bricks[i].Destroyed)
+            this->Words[i / 64] |= bit;
+        else
+            this->Words[i / 64] &= ~bit;
+    }
+    this->chunkVersions[chunk] = range.Version;
+}
+
+void BrickBits::Apply(const uint64_t *words, GameLevel &level)
+{
+    for (LevelChunk &chunk : level.Chunks)
+    {
+        bool changed = false;
+        for (unsigned int i = chunk.First; i < chunk.First + chunk.Count; i++)
+        {
+            bool destroyed = (words[i / 64] >> (i % 64)) & 1;
+            if (level.Bricks[i].Destroyed != destroyed)
+            {
+                level.Bricks[i].Destroyed = destroyed;
+                changed = true;
+            }
+        }
+        if (changed)
+            chunk.Version++; // renderer re-uploads it
+    }
+    this->Invalidate(); // versions moved, rebuilt on next Update
+}
+
+void BrickBits::Invalidate()
+{
+    this->generation = 0;
+}
+
+// LEB128: 7 bits per byte, high bit set on all but the last
+static size_t writeLength(size_t length, unsigned char *out)
+{
+    size_t n = 0;
+    do
+    {
+        unsigned char byte = length & 0x7F;
+        length >>= 7;
+        out[n++] = byte | (length != 0 ? 0x80 : 0);
+    } while (length != 0);
+    return n;
+}
+
+static bool readLength(const unsigned char *in, size_t size, size_t &i, size_t &length)
+{
+    length = 0;
+    for (unsigned int shift = 0; i < size && shift < 64; shift += 7)
+    {
+        unsigned char byte = in[i++];
+        length |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+const size_t MIN_ZERO_RUN = 3; // shorter ones cost as much as staying literal
+const size_t MAX_LITERAL = 255;
+
+size_t DeltaCodec::MaxEncodedSize(size_t size)
+{
+    return size + size / MAX_LITERAL + 16;
+}
+
+/**
+ * Zero runs are found 8 bytes at a time, a mostly unchanged state is skipped
+ * at memory speed.
+ */
+size_t DeltaCodec::Encode(const unsigned char *data, const unsigned char *reference, size_t size, unsigned char *out)
+{
+    auto delta = [&](size_t k) -> unsigned char { return reference != nullptr ? data[k] ^ reference[k] : data[k]; };
+    auto zeroRun = [&](size_t k, size_t limit) -> size_t
+    {
+        size_t end = k;
+        while (end + 8 <= limit)
+        {
+            uint64_t a, b = 0;
+            std::memcpy(&a, data + end, 8);
+            if (reference != nullptr)
+                std::memcpy(&b, reference + end, 8);
+            if ((a ^ b) != 0)
+                break;
+            end += 8;
+        }
+        while (end < limit && delta(end) == 0)
+            end++;
+        return end - k;
+    };
+
+    size_t o = 0, i = 0;
+    while (i < size)
+    {
+        size_t zeros = zeroRun(i, size);
+        if (zeros >= MIN_ZERO_RUN || i + zeros == size)
+        {
+            out[o++] = 0;
+            o += writeLength(zeros, out + o);
+            i += zeros;
+            continue;
+        }
+
+        // literal, up to the next zero run worth encoding as one
+        size_t start = i;
+        while (i < size && i - start < MAX_LITERAL)
+        {
+            if (delta(i) == 0 && zeroRun(i, std::min(size, i + MIN_ZERO_RUN)) == std::min(MIN_ZERO_RUN, size - i))
+                break;
+            i++;
+        }
+        out[o++] = static_cast<unsigned char>(i - start);
+        for (size_t k = start; k < i; k++)
+            out[o++] = delta(k);
+    }
+    return o;
+}
+
+bool DeltaCodec::Decode(const unsigned char *encoded, size_t encodedSize, const unsigned char *reference, unsigned char *out, size_t size)
+{
+    size_t i = 0, o = 0;
+    while (i < encodedSize)
+    {
+        size_t length = encoded[i++];
+        if (length == 0) // zero run, same as reference
+        {
+            if (!readLength(encoded, encodedSize, i, length) || length > size - o)
+                return false;
+            if (reference != nullptr)
+                std::memcpy(out + o, reference + o, length);
+            else
+                std::memset(out + o, 0, length);
+        }
+        else
+        {
+            if (length > encodedSize - i || length > size - o)
+                return false;
+            for (size_t k = 0; k < length; k++)
+                out[o + k] = encoded[i + k] ^ (reference != nullptr ? reference[o + k] : 0);
+            i += length;
+        }
+        o += length;
+    }
+    return o == size;
+}
+
+const char STATE_MAGIC[4] = { 'B', 'S', 'A', 'V' };
+const uint32_t STATE_VERSION = 1;
+
+bool StateFile::Write(const char *file, const std::vector<unsigned char> &state)
+{
+    std::vector<unsigned char> contents(sizeof(StateFileHeader) + DeltaCodec::MaxEncodedSize(state.size()));
+    StateFileHeader header;
+    std::memcpy(header.Magic, STATE_MAGIC, sizeof(STATE_MAGIC));
+    header.Version = STATE_VERSION;
+    header.StateSize = state.size();
+    header.Checksum = LevelFile::Checksum(state.data(), state.size());
+    std::memcpy(contents.data(), &header, sizeof(header));
+    contents.resize(sizeof(header) + DeltaCodec::Encode(state.data(), nullptr, state.size(), contents.data() + sizeof(header)));
+
+    FILE *out = std::fopen(file, "wb");
+    bool ok = out != nullptr && std::fwrite(contents.data(), 1, contents.size(), out) == contents.size();
+    if (out != nullptr)
+        ok = std::fclose(out) == 0 && ok;
+    if (!ok)
+        std::cout << "ERROR::STATE: Failed to write save state: " << file << std::endl;
+    return ok;
+}
+
+bool StateFile::Read(const char *file, std::vector<unsigned char> &state)
+{
+    std::vector<unsigned char> contents;
+    FILE *in = std::fopen(file, "rb");
+    if (in != nullptr)
+    {
+        unsigned char buffer[4096];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), in)) > 0)
+            contents.insert(contents.end(), buffer, buffer + n);
+        std::fclose(in);
+    }
+
+    StateFileHeader header;
+    bool ok = contents.size() >= sizeof(header);
+    if (ok)
+    {
+        std::memcpy(&header, contents.data(), sizeof(header));
+        ok = std::memcmp(header.Magic, STATE_MAGIC, sizeof(STATE_MAGIC)) == 0 && header.Version == STATE_VERSION;
+    }
+    if (ok)
+    {
+        state.resize(header.StateSize);
+        ok = DeltaCodec::Decode(contents.data() + sizeof(header), contents.size() - sizeof(header), nullptr, state.data(), state.size())
+            && LevelFile::Checksum(state.data(), state.size()) == header.Checksum;
+    }
+    if (!ok)
+        std::cout << "ERROR::STATE: Failed to read save state (missing, corrupt or other version): " << file << std::endl;
+    return ok;
+}
+
+SnapshotRing::SnapshotRing(size_t bytes, unsigned int maxEntries, unsigned int keyframeInterval)
+    : bytes(bytes), entries(maxEntries), first(0), count(0), writeOffset(0), keyframeInterval(keyframeInterval), keyframe(0), reference(), sinceKeyframe(0)
+{
+}
+
+void SnapshotRing::Push(uint64_t tick, const unsigned char *state, size_t size)
+{
+    size_t offset;
+    if (!this->reserve(DeltaCodec::MaxEncodedSize(size), offset))
+        return; // state bigger than the whole ring, no rewinding this level
+
+    uint64_t sequence = this->first + this->count;
+    bool keyframe = this->count == 0 || this->first > this->keyframe // its keyframe just made room
+        || this->sinceKeyframe + 1 >= this->keyframeInterval || this->reference.size() != size;
+
+    Entry &entry = this->entry(sequence);
+    entry.Tick = tick;
+    entry.Offset = offset;
+    entry.StateSize = size;
+    entry.Size = DeltaCodec::Encode(state, keyframe ? nullptr : this->reference.data(), size, this->bytes.data() + offset);
+    if (keyframe)
+    {
+        entry.Keyframe = sequence;
+        this->keyframe = sequence;
+        this->reference.assign(state, state + size);
+        this->sinceKeyframe = 0;
+    }
+    else
+    {
+        entry.Keyframe = this->keyframe;
+        this->sinceKeyframe++;
+    }
+    this->count++;
+    this->writeOffset = offset + entry.Size;
+}
+
+bool SnapshotRing::Rewind(unsigned int ticks, std::vector<unsigned char> &state, uint64_t &tick)
+{
+    if (this->count == 0)
+        return false;
+
+    this->count -= std::min(ticks, this->count - 1);
+    uint64_t newest = this->first + this->count - 1;
+    const Entry &entry = this->entry(newest);
+    this->writeOffset = entry.Offset + entry.Size; // dropped ones are free again
+
+    // deltas from here on go against this entry's keyframe
+    if (entry.Keyframe != this->keyframe)
+    {
+        const Entry &key = this->entry(entry.Keyframe);
+        this->keyframe = entry.Keyframe;
+        this->reference.resize(key.StateSize);
+        if (!this->decode(key, nullptr, this->reference.data()))
+        {
+            this->Clear();
+            return false;
+        }
+    }
+    this->sinceKeyframe = static_cast<unsigned int>(newest - entry.Keyframe);
+
+    state.resize(entry.StateSize);
+    tick = entry.Tick;
+    if (entry.Keyframe == newest)
+        std::memcpy(state.data(), this->reference.data(), entry.StateSize);
+    else if (!this->decode(entry, this->reference.data(), state.data()))
+    {
+        this->Clear();
+        return false;
+    }
+    return true;
+}
+
+void SnapshotRing::Clear()
+{
+    this->first += this->count;
+    this->count = 0;
+    this->writeOffset = 0;
+}
+
+size_t SnapshotRing::BytesUsed() const
+{
+    size_t used = 0;
+    for (uint64_t s = this->first; s < this->first + this->count; s++)
+        used += this->entries[s % this->entries.size()].Size;
+    return used;
+}
+
+unsigned int SnapshotRing::KeyframeCount() const
+{
+    unsigned int keyframes = 0;
+    for (uint64_t s = this->first; s < this->first + this->count; s++)
+        keyframes += this->entries[s % this->entries.size()].Keyframe == s;
+    return keyframes;
+}
+
+/**
+ * Entries sit back to back and wrap to the start when the end is too short,
+ * so free space is either after the newest or between the newest and the
+ * oldest (once wrapped).
+ */
+bool SnapshotRing::reserve(size_t size, size_t &offset)
+{
+    if (size > this->bytes.size() || this->entries.empty())
+        return false;
+
+    while (true)
+    {
+        if (this->count == this->entries.size())
+        {
+            this->evictOldest();
+            continue;
+        }
+        if (this->count == 0)
+        {
+            offset = 0;
+            return true;
+        }
+
+        size_t head = this->entry(this->first).Offset;
+        if (this->writeOffset > head) // not wrapped
+        {
+            if (this->bytes.size() - this->writeOffset >= size)
+            {
+                offset = this->writeOffset;
+                return true;
+            }
+            if (head >= size)
+            {
+                offset = 0;
+                return true;
+            }
+        }
+        else if (head - this->writeOffset >= size)
+        {
+            offset = this->writeOffset;
+            return true;
+        }
+        this->evictOldest();
+    }
+}
+
+void SnapshotRing::evictOldest()
+{
+    this->first++;
+    this->count--;
+    // deltas can't be decoded without their keyframe
+    while (this->count > 0 && this->entry(this->first).Keyframe != this->first)
+    {
+        this->first++;
+        this->count--;
+    }
+}
+
+bool SnapshotRing::decode(const Entry &entry, const unsigned char *reference, unsigned char *out)
+{
+    return DeltaCodec::Decode(this->bytes.data() + entry.Offset, entry.Size, reference, out, entry.StateSize);
+}
@@ -0,0 +1,178 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "FrameSnapshot.h"
+#include "PowerUps.h"
+
+class GameLevel;
+
+/**
+ * Sim state for rewind & save states, as one binary blob:
+ *
+ *   SimState
+ *   brick bits: one bit per brick of the current level (1 = destroyed), in
+ *               64 bit words, BrickCount bits rounded up
+ *
+ * Plain data, written byte for byte in host byte order. The sim fills it with
+ * zeroed padding, so unchanged state is identical bytes and XOR deltas of it
+ * are zero. Particles aren't part of it, they are only looks.
+ */
+struct BallState
+{
+    glm::vec2 Position, Velocity;
+    glm::vec3 Color;
+    uint8_t Stuck, Sticky, PassThrough, Padding;
+};
+
+struct SimState
+{
+    uint32_t State;           // GameState
+    uint32_t Level;
+    uint32_t LevelGeneration; // GameLevel::Generation, only meaningful within a run
+    uint32_t BrickCount;      // bits that follow
+    uint32_t BricksLeft;
+
+    glm::vec2 PlayerPosition, PlayerSize;
+    glm::vec3 PlayerColor;
+    BallState Ball;
+    BallState ExtraBalls[MAX_EXTRA_BALLS];
+    uint32_t ExtraBallCount;
+
+    float PowerUpX[PowerUpPool::CAPACITY], PowerUpY[PowerUpPool::CAPACITY];
+    uint8_t PowerUpType[PowerUpPool::CAPACITY];
+    uint32_t PowerUpCount;
+    float EffectsRemaining[POWERUP_TYPES];
+
+    uint32_t PowerUpRandom;
+    float ShakeTime, FlashTime;
+};
+
+/**
+ * Destroyed flags of a level's bricks as a bitset. Update only looks at chunks
+ * whose Version changed since last time, so keeping it current every tick is
+ * cheap however big the level is.
+ */
+class BrickBits
+{
+    public:
+        std::vector<uint64_t> Words;
+
+        BrickBits();
+
+        void Update(const GameLevel &level); // rebuilds everything when it's another level (or a reload)
+        void Apply(const uint64_t *words, GameLevel &level); // sets level's bricks from words, bumps Version of chunks that changed
+        void Invalidate(); // next Update rebuilds all
+
+        static size_t WordCount(size_t bricks) { return (bricks + 63) / 64; }
+
+    private:
+        unsigned int generation; // of level Words are for
+        std::vector<unsigned int> chunkVersions;
+
+        void updateChunk(const GameLevel &level, unsigned int chunk);
+};
+
+/**
+ * XOR against a reference, then run length encode: a zero byte followed by a
+ * LEB128 length for runs of zeros, else a count (1 - 255) followed by that
+ * many literal bytes. Without a reference the data itself is encoded.
+ */
+class DeltaCodec
+{
+    public:
+        static size_t MaxEncodedSize(size_t size);
+        // returns bytes written to out (at least MaxEncodedSize(size) of room)
+        static size_t Encode(const unsigned char *data, const unsigned char *reference, size_t size, unsigned char *out);
+        // false if encoded doesn't decode to exactly size bytes
+        static bool Decode(const unsigned char *encoded, size_t encodedSize, const unsigned char *reference, unsigned char *out, size_t size);
+
+    private:
+        DeltaCodec();
+};
+
+/**
+ * Save state file (.sav):
+ *
+ *   StateFileHeader
+ *   state blob, DeltaCodec encoded without reference
+ *
+ * Checksum is FNV-1a (LevelFile::Checksum) over the decoded blob.
+ */
+struct StateFileHeader
+{
+    char Magic[4];          // "BSAV"
+    uint32_t Version;
+    uint64_t StateSize;     // decoded
+    uint64_t Checksum;
+};
+
+class StateFile
+{
+    public:
+        static bool Write(const char *file, const std::vector<unsigned char> &state); // prints error on failure
+        static bool Read(const char *file, std::vector<unsigned char> &state);        // validates, prints error on failure
+
+    private:
+        StateFile();
+};
+
+/**
+ * The last few seconds of sim state, one entry per tick, for rewinding.
+ *
+ * Every KeyframeInterval ticks (and whenever the state size changes) an entry
+ * is a keyframe, encoded on its own. The others are XOR deltas against their
+ * keyframe, which are mostly zeros and shrink to a few bytes. Entries are
+ * written one after another into a fixed byte buffer; the oldest ones (and
+ * deltas whose keyframe went with them) make room, so memory never grows
+ * after construction, apart from the decoded keyframe (sized to the state).
+ *
+ * Rewinding drops the newest entries and decodes the one then newest, at most
+ * two decodes whatever the distance.
+ */
+class SnapshotRing
+{
+    public:
+        SnapshotRing(size_t bytes, unsigned int maxEntries, unsigned int keyframeInterval);
+
+        void Push(uint64_t tick, const unsigned char *state, size_t size);
+        // drops the newest ticks entries (never the oldest one) & decodes what is newest then, false if empty
+        bool Rewind(unsigned int ticks, std::vector<unsigned char> &state, uint64_t &tick);
+        void Clear();
+
+        unsigned int Count() const { return this->count; }
+        size_t BytesUsed() const;
+        unsigned int KeyframeCount() const;
+
+    private:
+        struct Entry
+        {
+            uint64_t Tick;
+            size_t Offset, Size;    // in bytes
+            size_t StateSize;       // decoded
+            uint64_t Keyframe;      // sequence number of its keyframe, itself for keyframes
+        };
+
+        std::vector<unsigned char> bytes;
+        std::vector<Entry> entries; // entry of sequence number s at s % size
+        uint64_t first;             // sequence number of oldest entry
+        unsigned int count;
+        size_t writeOffset;
+        unsigned int keyframeInterval;
+
+        uint64_t keyframe;                 // sequence number of keyframe new deltas refer to
+        std::vector<unsigned char> reference; // that keyframe, decoded
+        unsigned int sinceKeyframe;        // deltas pushed against it
+
+        Entry& entry(uint64_t sequence) { return this->entries[sequence % this->entries.size()]; }
+        bool reserve(size_t size, size_t &offset); // evicts until size bytes fit, false if they never will
+        void evictOldest();
+        bool decode(const Entry &entry, const unsigned char *reference, unsigned char *out);
+};
+
+#endif
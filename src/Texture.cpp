@@ -6,7 +6,6 @@
 Texture2D::Texture2D()
     : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
 {
-    glGenTextures(1, &this->ID);
 }
 
 void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
@@ -14,8 +13,14 @@ void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char*
     this->Width = width;
     this->Height = height;
 
-    // Create texture
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    // Create texture (once, reloads reuse the name so views stay valid)
+    if (this->ID.Get() == 0)
+    {
+        unsigned int id;
+        glGenTextures(1, &id);
+        this->ID.Reset(id);
+    }
+    glBindTexture(GL_TEXTURE_2D, this->ID.Get());
     glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
 
     // Configure texture
@@ -29,6 +34,11 @@ void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char*
 }
 
 void Texture2D::Bind() const
+{
+    glBindTexture(GL_TEXTURE_2D, this->ID.Get());
+}
+
+void TextureView::Bind() const
 {
     glBindTexture(GL_TEXTURE_2D, this->ID);
 }
\ No newline at end of file
@@ -3,10 +3,16 @@
 
 #include <glad/glad.h>
 
+#include "GLObject.h"
+
+/**
+ * Owns its OpenGL texture, so it can be moved but not copied. Hand out
+ * TextureViews to things that only draw with it.
+ */
 class Texture2D
 {
     public:
-        unsigned int ID;
+        GLTexture ID; // 0 until first Generate()
 
         unsigned int Width, Height;
         unsigned int Internal_Format; // format of texture object
@@ -19,10 +25,20 @@ class Texture2D
         unsigned int Filter_Max;
 
         Texture2D();
-        // What about destructor?
 
-        void Generate(unsigned int width, unsigned int height, unsigned char* data);
+        void Generate(unsigned int width, unsigned int height, unsigned char* data); // regenerating keeps the texture name
         void Bind() const;
 };
 
+// Non-owning reference to a Texture2D, cheap to copy into every sprite
+struct TextureView
+{
+    unsigned int ID;
+
+    TextureView() : ID(0) { }
+    TextureView(const Texture2D &texture) : ID(texture.ID.Get()) { }
+
+    void Bind() const;
+};
+
 #endif
\ No newline at end of file
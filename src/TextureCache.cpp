@@ -0,0 +1,198 @@
+#include "TextureCache.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+static_assert(sizeof(TextureCacheHeader) == 64, "cache header must keep pixels 64 byte aligned");
+
+const char CACHE_MAGIC[4] = { 'B', 'T', 'E', 'X' };
+const uint32_t CACHE_VERSION = 1;
+
+std::string TextureCache::CacheDir = "cache/";
+bool        TextureCache::Enabled = true;
+
+/**
+ * FNV-1a hash of file contents. Returns false if file could not be read.
+ */
+static bool hashFile(const char *file, uint64_t &hash)
+{
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    hash = 14695981039346656037ull;
+    unsigned char buffer[64 * 1024];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t i = 0; i < n; i++)
+        {
+            hash ^= buffer[i];
+            hash *= 1099511628211ull;
+        }
+    }
+    close(fd);
+    return n == 0;
+}
+
+static uint64_t mtimeNs(const struct stat &st)
+{
+    return static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
+}
+
+DecodedImage TextureCache::Decode(const char *file)
+{
+    DecodedImage image = { 0, 0, 0, nullptr, nullptr, 0, false };
+
+    if (Enabled && Load(file, image))
+        return image;
+
+    image.Data = stbi_load(file, &image.Width, &image.Height, &image.Channels, 0);
+
+    if (Enabled && image.Data != nullptr)
+        Store(file, image);
+
+    return image;
+}
+
+void TextureCache::Free(DecodedImage &image)
+{
+    if (image.Mapping != nullptr)
+        munmap(image.Mapping, image.MappingSize);
+    else if (!image.Borrowed)
+        stbi_image_free(image.Data);
+
+    image.Data = nullptr;
+    image.Mapping = nullptr;
+    image.MappingSize = 0;
+}
+
+// overwrites SourceMTime in place; if that fails the next load just hashes again
+static void updateMTime(const char *path, uint64_t mtime)
+{
+    int fd = open(path, O_WRONLY);
+    if (fd < 0)
+        return;
+    if (pwrite(fd, &mtime, sizeof(mtime), offsetof(TextureCacheHeader, SourceMTime)) != sizeof(mtime))
+        std::cout << "ERROR: could not update texture cache: " << path << std::endl;
+    close(fd);
+}
+
+bool TextureCache::Load(const char *file, DecodedImage &image)
+{
+    struct stat source;
+    if (stat(file, &source) != 0)
+        return false;
+
+    std::string path = CachePath(file);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) // not cached yet
+        return false;
+
+    struct stat cached;
+    if (fstat(fd, &cached) != 0 || cached.st_size < static_cast<off_t>(sizeof(TextureCacheHeader)))
+    {
+        close(fd);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, cached.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // mapping stays valid
+    if (mapping == MAP_FAILED)
+        return false;
+
+    const TextureCacheHeader *header = static_cast<const TextureCacheHeader*>(mapping);
+    size_t pixelBytes = static_cast<size_t>(header->Width) * header->Height * header->Channels;
+
+    bool valid = std::memcmp(header->Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0
+        && header->Version == CACHE_VERSION
+        && header->SourceSize == static_cast<uint64_t>(source.st_size)
+        && sizeof(TextureCacheHeader) + pixelBytes <= static_cast<size_t>(cached.st_size);
+
+    // mtime changed (e.g. file was touched or checked out again), only contents matter
+    if (valid && header->SourceMTime != mtimeNs(source))
+    {
+        uint64_t hash;
+        valid = hashFile(file, hash) && hash == header->SourceHash;
+        if (valid) // remember new mtime, so next load skips the hash again
+            updateMTime(path.c_str(), mtimeNs(source));
+    }
+
+    if (!valid) // stale, will be overwritten by Store()
+    {
+        munmap(mapping, cached.st_size);
+        return false;
+    }
+
+    image.Width = header->Width;
+    image.Height = header->Height;
+    image.Channels = header->Channels;
+    image.Data = static_cast<unsigned char*>(mapping) + sizeof(TextureCacheHeader);
+    image.Mapping = mapping;
+    image.MappingSize = cached.st_size;
+    return true;
+}
+
+void TextureCache::Store(const char *file, const DecodedImage &image)
+{
+    struct stat source;
+    TextureCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+
+    if (stat(file, &source) != 0 || !hashFile(file, header.SourceHash))
+        return;
+
+    std::memcpy(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.Version = CACHE_VERSION;
+    header.Width = image.Width;
+    header.Height = image.Height;
+    header.Channels = image.Channels;
+    header.SourceMTime = mtimeNs(source);
+    header.SourceSize = source.st_size;
+
+    mkdir(CacheDir.c_str(), 0755); // fails harmlessly if it already exists
+
+    // write to temporary file first so a crash never leaves a half written cache file
+    std::string path = CachePath(file);
+    std::string tmpPath = path + ".tmp";
+    FILE *out = std::fopen(tmpPath.c_str(), "wb");
+    if (out == nullptr)
+    {
+        std::cout << "ERROR: could not write texture cache: " << tmpPath << std::endl;
+        return;
+    }
+
+    size_t pixelBytes = static_cast<size_t>(image.Width) * image.Height * image.Channels;
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1
+        && std::fwrite(image.Data, 1, pixelBytes, out) == pixelBytes;
+    ok = std::fclose(out) == 0 && ok;
+
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::cout << "ERROR: could not write texture cache: " << path << std::endl;
+        std::remove(tmpPath.c_str());
+    }
+}
+
+/**
+ * textures/block.png --> cache/textures_block.png.tex
+ */
+std::string TextureCache::CachePath(const char *file)
+{
+    std::string name(file);
+    for (char &c : name)
+    {
+        if (c == '/' || c == '\\')
+            c = '_';
+    }
+    return CacheDir + name + ".tex";
+}
@@ -0,0 +1,64 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Pixels decoded from an image file, not yet uploaded to OpenGL
+struct DecodedImage
+{
+    int Width, Height, Channels;
+    unsigned char *Data; // nullptr if decoding failed
+
+    // set when Data points into a memory-mapped cache file instead of a stb_image buffer
+    void *Mapping;
+    size_t MappingSize;
+
+    bool Borrowed; // Data belongs to someone else (e.g. asset pack), Free() leaves it alone
+};
+
+// Header at the start of every cache file, pixels follow right after it
+struct TextureCacheHeader
+{
+    char Magic[4];          // "BTEX"
+    uint32_t Version;
+    uint32_t Width, Height;
+    uint32_t Channels;      // 3 = RGB, 4 = RGBA
+    uint32_t Reserved;
+    uint64_t SourceMTime;   // nanoseconds
+    uint64_t SourceSize;
+    uint64_t SourceHash;    // FNV-1a of source file contents
+    uint64_t Padding[2];    // keep pixel data 64 byte aligned
+};
+
+/**
+ * On-disk cache of decoded images.
+ *
+ * First load of an image decodes it with stb_image and writes the raw pixels to
+ * CacheDir. Later loads mmap the cache file and hand out a pointer into the mapping,
+ * so nothing is decoded or copied. A cache file is used only if the source file's
+ * mtime and size match, or, when the mtime changed, its contents still hash the same
+ * (the new mtime is then written to the cache file, so that only happens once).
+ */
+class TextureCache
+{
+    public:
+        static std::string CacheDir;
+        static bool Enabled;
+
+        // Thread safe. Free result with Free().
+        static DecodedImage Decode(const char *file);
+        static void Free(DecodedImage &image);
+
+        // Just the cache part of Decode
+        static bool Load(const char *file, DecodedImage &image);
+        static void Store(const char *file, const DecodedImage &image);
+
+        static std::string CachePath(const char *file);
+
+    private:
+        TextureCache();
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+/**
+ * Lock-free single writer, single reader triple buffer.
+ *
+ * The writer fills Back() and publishes it, the reader always gets the latest
+ * published value. Three slots mean each side always has one to itself, so
+ * neither ever waits for the other; values the reader was too slow to see are
+ * simply skipped.
+ */
+template <typename T>
+class TripleBuffer
+{
+    public:
+        TripleBuffer() : middle(1), back(0), front(2) { }
+
+        // writer side
+        T& Back() { return this->slots[this->back]; }
+        void Publish()
+        {
+            unsigned int previous = this->middle.exchange(this->back | FRESH, std::memory_order_acq_rel);
+            this->back = previous & INDEX;
+        }
+
+        // reader side, value stays valid (and unchanged) until next call
+        const T& Front()
+        {
+            if (this->middle.load(std::memory_order_relaxed) & FRESH)
+            {
+                unsigned int previous = this->middle.exchange(this->front, std::memory_order_acq_rel);
+                this->front = previous & INDEX;
+            }
+            return this->slots[this->front];
+        }
+
+    private:
+        static const unsigned int INDEX = 3;
+        static const unsigned int FRESH = 4; // middle slot holds something reader hasn't seen
+
+        T slots[3];
+        std::atomic<unsigned int> middle; // slot in between writer and reader, plus FRESH bit
+        unsigned int back;  // only touched by writer
+        unsigned int front; // only touched by reader
+
+        TripleBuffer(const TripleBuffer&);
+        TripleBuffer& operator=(const TripleBuffer&);
+};
+
+#endif
@@ -3,13 +3,24 @@
 
 #include "Game.h"
 #include "ResourceManager.h"
+#include "FramePacer.h"
+#include "Profiler.h"
+#include "FrameArena.h"
 
 #include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+#include <unistd.h>
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
+std::string executable_directory();
+bool parse_options(int argc, char *argv[], SyncMode &mode, double &fps, float &scale, std::string &audioFile);
+
 // The Width of the screen
 const unsigned int SCREEN_WIDTH = 800;
 // The height of the screen
@@ -19,11 +30,23 @@ Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 int main(int argc, char *argv[])
 {
+    // frame pacing: --sync vsync|adaptive|uncapped, --fps N (0 = no limiter)
+    // scene resolution: --scale auto|0.5-1 (auto follows GPU time, a number pins it)
+    // sound: --audio FILE.wav records it, otherwise it is mixed & discarded
+    SyncMode syncMode = SYNC_VSYNC;
+    double targetFps = 0.0;
+    if (!parse_options(argc, argv, syncMode, targetFps, Breakout.RenderScale, Breakout.AudioFile))
+    {
+        std::cout << "usage: " << argv[0] << " [--sync vsync|adaptive|uncapped] [--fps N] [--scale auto|0.5-1] [--audio FILE.wav]" << std::endl;
+        return 1;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_RESIZABLE, false);
+    glfwWindowHint(GLFW_RESIZABLE, true);
+    glfwWindowHint(GLFW_SCALE_TO_MONITOR, true); // HiDPI: bigger window, framebuffer size is in pixels anyway
 
     GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breakout", nullptr, nullptr);
     glfwMakeContextCurrent(window);
@@ -36,50 +59,90 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // swap interval, adaptive sync needs the swap_control_tear extension
+    // -------------------------------------------------------------------
+    FramePacer pacer(syncMode, targetFps);
+    int swapInterval = pacer.SwapInterval();
+    if (swapInterval < 0 && !glfwExtensionSupported("GLX_EXT_swap_control_tear") && !glfwExtensionSupported("WGL_EXT_swap_control_tear"))
+    {
+        std::cout << "Adaptive sync not supported, using vsync" << std::endl;
+        swapInterval = 1;
+    }
+    glfwSwapInterval(swapInterval);
+
     glfwSetKeyCallback(window, key_callback);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
     // OpenGL configuration
     // --------------------
-    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // initialize game
-    // ---------------
+    // asset pack next to executable (see make pack), without one loose files are loaded
+    // ----------------------------------------------------------------------------------
+    std::string packFile = executable_directory() + "/assets.pak";
+    if (ResourceManager::OpenPack(packFile.c_str()))
+        std::cout << "Using asset pack: " << packFile << std::endl;
+
+#ifdef ENABLE_PROFILER
+    // profile on demand (socat -u UNIX-CONNECT:<socket> - > profile.json), also dumped on exit
+    // -----------------------------------------------------------------------------------------
+    PROFILE_THREAD("render");
+    Profiler::Listen("/tmp/breakout-profile.sock");
+#endif
+
+    // initialize game, GPU budget for dynamic resolution is a frame at the target (or refresh) rate
+    // ---------------------------------------------------------------------------------------------
+    const GLFWvidmode *video = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    double frameRate = targetFps > 0.0 ? targetFps : (video != nullptr && video->refreshRate > 0 ? video->refreshRate : 60.0);
+    Breakout.GpuBudgetMs = static_cast<float>(1000.0 / frameRate);
     Breakout.Init();
+    Breakout.Resize(framebufferWidth, framebufferHeight);
 
-    // deltaTime variables
-    // -------------------
-    float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
+    // input & game state are updated on the sim thread from here on,
+    // this thread owns the GL context and only draws what the sim publishes
+    // -----------------------------------------------------------------------
+    Breakout.Start();
 
     while (!glfwWindowShouldClose(window))
     {
-        // calculate delta time
-        // --------------------
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
         glfwPollEvents();
 
-        // manage user input
-        // -----------------
-        Breakout.ProcessInput(deltaTime);
+        // last frame's transient data is gone, the one before that's arena is reused
+        // ----------------------------------------------------------------------------
+        RenderArena.Swap();
 
-        // update game state
-        // -----------------
-        Breakout.Update(deltaTime);
+        // hot reload changed assets
+        // -------------------------
+        Breakout.ReloadAssets();
 
-        // render
-        // ------
+        // render latest sim snapshot
+        // --------------------------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
         Breakout.Render();
 
         glfwSwapBuffers(window);
+        Breakout.FramePresented();
+
+        // hold frame until its deadline (if limiting) & track frame times
+        // -----------------------------------------------------------------
+        pacer.FrameEnd();
     }
 
+    Breakout.Stop();
+
+    FrameArena::Stats arena = RenderArena.GetStats();
+    std::cout << "ARENA: render high water " << arena.HighWater << " of " << arena.Capacity << " bytes" << std::endl;
+
+#ifdef ENABLE_PROFILER
+    Profiler::Close();
+    Profiler::Dump("profile.json");
+#endif
+
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
     ResourceManager::Clear();
@@ -93,18 +156,55 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     // when a user presses the escape key, we set the WindowShouldClose property to true, closing the application
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
-    if (key >= 0 && key < 1024)
-    {
-        if (action == GLFW_PRESS)
-            Breakout.Keys[key] = true;
-        else if (action == GLFW_RELEASE)
-            Breakout.Keys[key] = false;
-    }
+    // overlay belongs to the render thread, which is this one
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+        Breakout.ShowOverlay = !Breakout.ShowOverlay;
+    // sim thread applies it at the time it happened (dropped if sim is stalled & queue full)
+    if (key >= 0 && key < 1024 && (action == GLFW_PRESS || action == GLFW_RELEASE))
+        Breakout.Input.Push(InputEvent{ key, action == GLFW_PRESS, FramePacer::NowNs() });
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    // make sure the viewport matches the new window dimensions; note that width and 
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
+    // width and height are in pixels, significantly larger than the window size on
+    // HiDPI (retina) displays; game letterboxes & scales its view to fit
+    Breakout.Resize(width, height);
+}
+
+std::string executable_directory()
+{
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0)
+        return ".";
+
+    std::string exe(path, length);
+    return exe.substr(0, exe.find_last_of('/'));
+}
+
+bool parse_options(int argc, char *argv[], SyncMode &mode, double &fps, float &scale, std::string &audioFile)
+{
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+            return false;
+
+        if (std::strcmp(argv[i], "--fps") == 0)
+            fps = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--sync") == 0 && std::strcmp(argv[i + 1], "vsync") == 0)
+            mode = SYNC_VSYNC;
+        else if (std::strcmp(argv[i], "--sync") == 0 && std::strcmp(argv[i + 1], "adaptive") == 0)
+            mode = SYNC_ADAPTIVE;
+        else if (std::strcmp(argv[i], "--sync") == 0 && std::strcmp(argv[i + 1], "uncapped") == 0)
+            mode = SYNC_UNCAPPED;
+        else if (std::strcmp(argv[i], "--scale") == 0 && std::strcmp(argv[i + 1], "auto") == 0)
+            scale = 0.0f;
+        else if (std::strcmp(argv[i], "--scale") == 0 && std::atof(argv[i + 1]) > 0.0)
+            scale = std::atof(argv[i + 1]); // clamped by ResolutionScaler
+        else if (std::strcmp(argv[i], "--audio") == 0)
+            audioFile = argv[i + 1];
+        else
+            return false;
+    }
+    return fps >= 0.0;
 }
\ No newline at end of file
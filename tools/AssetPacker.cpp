@@ -0,0 +1,184 @@
+/**
+ * Builds an asset pack (see AssetPack.h) from shader, image and level files.
+ *
+ * usage: packer <output.pak> <files...>
+ *
+ * Run from the repo root so entry names match the paths the game loads
+ * (e.g. "shaders/sprite.vs"). Images are decoded here, .lvl text levels are
+ * converted to the binary level format.
+ */
+#include "AssetPack.h"
+#include "LevelFile.h"
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct PackItem
+{
+    PackEntry Entry;
+    std::vector<unsigned char> Blob;
+};
+
+static bool endsWith(const std::string &value, const char *suffix)
+{
+    size_t length = std::strlen(suffix);
+    return value.size() >= length && value.compare(value.size() - length, length, suffix) == 0;
+}
+
+static bool readFile(const char *file, std::vector<unsigned char> &contents)
+{
+    FILE *in = std::fopen(file, "rb");
+    if (in == nullptr)
+    {
+        std::cout << "ERROR: could not open file: " << file << std::endl;
+        return false;
+    }
+
+    unsigned char buffer[64 * 1024];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), in)) > 0)
+        contents.insert(contents.end(), buffer, buffer + n);
+    std::fclose(in);
+    return true;
+}
+
+static bool packFile(const char *file, PackItem &item)
+{
+    std::string name(file);
+    while (name.compare(0, 2, "./") == 0) // "./shaders/sprite.vs" is loaded as "shaders/sprite.vs"
+        name.erase(0, 2);
+    if (name.size() >= PACK_NAME_LENGTH)
+    {
+        std::cout << "ERROR: name too long for pack: " << file << std::endl;
+        return false;
+    }
+
+    std::memset(&item.Entry, 0, sizeof(item.Entry));
+    std::memcpy(item.Entry.Name, name.c_str(), name.size());
+
+    if (endsWith(name, ".vs") || endsWith(name, ".fs") || endsWith(name, ".gs"))
+    {
+        item.Entry.Type = PACK_SHADER;
+        if (!readFile(file, item.Blob))
+            return false;
+        item.Blob.push_back('\0'); // ready for glShaderSource
+    }
+    else if (endsWith(name, ".png") || endsWith(name, ".jpg") || endsWith(name, ".jpeg"))
+    {
+        item.Entry.Type = PACK_TEXTURE;
+        DecodedImage image = TextureCache::Decode(file);
+        if (image.Data == nullptr)
+        {
+            std::cout << "ERROR: failed to load image: " << file << std::endl;
+            return false;
+        }
+        item.Entry.Width = image.Width;
+        item.Entry.Height = image.Height;
+        item.Entry.Channels = image.Channels;
+        item.Blob.assign(image.Data, image.Data + static_cast<size_t>(image.Width) * image.Height * image.Channels);
+        TextureCache::Free(image);
+    }
+    else if (endsWith(name, ".lvl"))
+    {
+        item.Entry.Type = PACK_LEVEL;
+        LevelData level = LevelData();
+        std::vector<unsigned char> tiles;
+        if (!LevelFile::ReadText(file, tiles, level.Width, level.Height))
+            return false;
+        level.Tiles = tiles.data();
+        LevelFile::Serialize(level, item.Blob);
+    }
+    else if (endsWith(name, ".blvl"))
+    {
+        item.Entry.Type = PACK_LEVEL;
+        if (!readFile(file, item.Blob))
+            return false;
+    }
+    else
+    {
+        std::cout << "ERROR: unknown asset type: " << file << std::endl;
+        return false;
+    }
+
+    item.Entry.Size = item.Blob.size();
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: " << argv[0] << " <output.pak> <files...>" << std::endl;
+        return 1;
+    }
+
+    TextureCache::Enabled = false; // pack holds decoded pixels itself
+
+    std::vector<PackItem> items(argc - 2);
+    for (int i = 2; i < argc; i++)
+    {
+        if (!packFile(argv[i], items[i - 2]))
+            return 1;
+    }
+
+    // sorted, so the game can binary search the index
+    std::sort(items.begin(), items.end(), [](const PackItem &a, const PackItem &b) {
+        return std::strcmp(a.Entry.Name, b.Entry.Name) < 0;
+    });
+    for (unsigned int i = 1; i < items.size(); i++)
+    {
+        if (std::strcmp(items[i - 1].Entry.Name, items[i].Entry.Name) == 0)
+        {
+            std::cout << "ERROR: file given twice: " << items[i].Entry.Name << std::endl;
+            return 1;
+        }
+    }
+
+    // lay out blobs after index
+    uint64_t offset = sizeof(PackHeader) + items.size() * sizeof(PackEntry);
+    for (PackItem &item : items)
+    {
+        offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+        item.Entry.Offset = offset;
+        offset += item.Entry.Size;
+    }
+
+    PackHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.Magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.Version = PACK_VERSION;
+    header.EntryCount = items.size();
+
+    FILE *out = std::fopen(argv[1], "wb");
+    if (out == nullptr)
+    {
+        std::cout << "ERROR: could not write file: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1;
+    for (PackItem &item : items)
+        ok = ok && std::fwrite(&item.Entry, sizeof(item.Entry), 1, out) == 1;
+    for (PackItem &item : items)
+    {
+        static const unsigned char zeros[PACK_ALIGNMENT] = {};
+        long padding = static_cast<long>(item.Entry.Offset) - std::ftell(out);
+        ok = ok && std::fwrite(zeros, 1, padding, out) == static_cast<size_t>(padding);
+        ok = ok && std::fwrite(item.Blob.data(), 1, item.Blob.size(), out) == item.Blob.size();
+    }
+    ok = std::fclose(out) == 0 && ok;
+
+    if (!ok)
+    {
+        std::cout << "ERROR: could not write file: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << argv[1] << ": " << items.size() << " assets, " << offset << " bytes" << std::endl;
+    return 0;
+}
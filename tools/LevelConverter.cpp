@@ -0,0 +1,54 @@
+/**
+ * Converts .lvl text levels to the binary .blvl format (see LevelFile.h).
+ *
+ * usage: lvl2blvl <input.lvl> <output.blvl> [--palette]
+ *
+ * --palette stores the game's default brick colors in the file, so they can be
+ * edited later without touching code.
+ */
+#include "LevelFile.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// colors of tile codes 0 - 5, same as GameLevel
+const float DEFAULT_PALETTE[] = {
+    1.0f, 1.0f, 1.0f, // empty (unused)
+    0.8f, 0.8f, 0.7f, // solid
+    0.2f, 0.6f, 1.0f,
+    0.0f, 0.7f, 0.0f,
+    0.8f, 0.8f, 0.4f,
+    1.0f, 0.5f, 0.0f
+};
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3 || argc > 4 || (argc == 4 && std::strcmp(argv[3], "--palette") != 0))
+    {
+        std::cout << "usage: " << argv[0] << " <input.lvl> <output.blvl> [--palette]" << std::endl;
+        return 1;
+    }
+
+    LevelData level = LevelData();
+    std::vector<unsigned char> tiles;
+    if (!LevelFile::ReadText(argv[1], tiles, level.Width, level.Height))
+    {
+        return 1;
+    }
+    level.Tiles = tiles.data();
+
+    if (argc == 4)
+    {
+        level.Palette = DEFAULT_PALETTE;
+        level.PaletteSize = sizeof(DEFAULT_PALETTE) / (3 * sizeof(float));
+    }
+
+    if (!LevelFile::WriteBinary(argv[2], level))
+    {
+        return 1;
+    }
+
+    std::cout << argv[1] << " (" << level.Width << "x" << level.Height << ") --> " << argv[2] << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * Writes a procedurally generated level (see LevelGenerator.h).
+ *
+ * usage: lvlgen <output.lvl|output.blvl> <width> <height> [options]
+ *
+ *   --seed N              (default 1)
+ *   --pattern NAME        noise, maze or symmetric (default noise)
+ *   --density F           chance a tile has a brick (default 0.7)
+ *   --solid F             chance a brick is solid (default 0.1)
+ *   --colors A,B,C,D      relative weights of brick codes 2 - 5 (default 1,1,1,1)
+ *
+ * The output format follows the extension, same seed & options give the same level.
+ */
+#include "LevelGenerator.h"
+#include "LevelFile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static void usage(const char *program)
+{
+    std::cout << "usage: " << program << " <output.lvl|output.blvl> <width> <height> [--seed N] [--pattern noise|maze|symmetric]"
+        << " [--density F] [--solid F] [--colors A,B,C,D]" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    LevelGeneratorSettings settings;
+    settings.Width = std::strtoul(argv[2], nullptr, 10);
+    settings.Height = std::strtoul(argv[3], nullptr, 10);
+    if (settings.Width == 0 || settings.Height == 0)
+    {
+        std::cout << "ERROR: level needs at least one tile" << std::endl;
+        return 1;
+    }
+
+    for (int i = 4; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        const char *option = argv[i], *value = argv[i + 1];
+        if (std::strcmp(option, "--seed") == 0)
+            settings.Seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(option, "--density") == 0)
+            settings.Density = std::strtof(value, nullptr);
+        else if (std::strcmp(option, "--solid") == 0)
+            settings.SolidRatio = std::strtof(value, nullptr);
+        else if (std::strcmp(option, "--colors") == 0 && std::sscanf(value, "%f,%f,%f,%f", &settings.ColorWeights[0],
+                 &settings.ColorWeights[1], &settings.ColorWeights[2], &settings.ColorWeights[3]) == 4)
+            continue;
+        else if (std::strcmp(option, "--pattern") == 0 && std::strcmp(value, "noise") == 0)
+            settings.Pattern = PATTERN_NOISE;
+        else if (std::strcmp(option, "--pattern") == 0 && std::strcmp(value, "maze") == 0)
+            settings.Pattern = PATTERN_MAZE;
+        else if (std::strcmp(option, "--pattern") == 0 && std::strcmp(value, "symmetric") == 0)
+            settings.Pattern = PATTERN_SYMMETRIC;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<unsigned char> tiles;
+    LevelData level = LevelGenerator::Generate(settings, tiles);
+
+    bool written = LevelFile::IsBinary(argv[1]) ? LevelFile::WriteBinary(argv[1], level) : LevelFile::WriteText(argv[1], level);
+    if (!written)
+        return 1;
+
+    std::cout << argv[1] << ": " << level.Width << "x" << level.Height << ", seed " << settings.Seed << std::endl;
+    return 0;
+}